@@ -8,55 +8,87 @@
  *		the read thread reads and prints the state.
  *		The program utilizes POSIX threads and synchronization mechanisms 
  *		such as mutexes and condition variables.
+ *		With "-m seqlock" the state is published through a sequence lock
+ *		instead, so the update thread never blocks on the reader.
+ *		With "-m ring" every sample is pushed into a lock-free ring
+ *		and the read thread drains all samples since its last read.
+ *		With "-m shm" the sequence lock lives in the shared memory
+ *		segment "/rtes_nav_state", so other processes (nav_attach)
+ *		can map it read-only and read the same snapshots.
+ *		All loops run on absolute-time periodic releases and report
+ *		their release jitter and overruns at exit. "-r hz" sets the
+ *		update rate (1 Hz or more); "-r 0" runs the update thread
+ *		unthrottled.
+ *		Threads log through binlog so no printf runs on their paths.
+ *		Each thread records the age of the data it consumes and its
+ *		lock wait, signal wait and lock hold times in its own
+ *		histograms. They are printed at exit and on SIGUSR1.
  * Date: 9th March 2023
  */
 
-#include <pthread.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <signal.h>
+#include <errno.h>
+
+#include "nav_state.h"
+#include "nav_seqlock.h"
+#include "nav_ring.h"
+#include "nav_shm.h"
+#include "periodic.h"
+#include "rt_time.h"
+#include "binlog.h"
+#include "nav_stats.h"
+#include "mutex_prof.h" // Contention profiling when built with -DMUTEX_PROF
 
-#define PI 3.14
 #define NUM_THREADS 2
 
 bool run_complete = false;
 pthread_cond_t signal_read = PTHREAD_COND_INITIALIZER;
 pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
-typedef struct {
-    double Latitude;
-    double Longitude;
-    double Altitude;
-    double Roll;
-    double Pitch;
-    double Yaw;
-    struct timespec timestamp;
-} nav_state;
-
 typedef struct {
     int thread_idx;
     nav_state *state;
+    nav_seqlock *pub;
+    nav_ring *ring;
+    nav_stats *stats;
 } thread_param;
 
+typedef enum { MODE_MUTEX, MODE_SEQLOCK, MODE_RING, MODE_SHM } pub_mode;
+
+static periodic_task update_task, read_task;
+static nav_stats update_stats, read_stats;
+
+void print_nav_state(int i, const nav_state *state) {
+    // Formatting is deferred to the logger thread, so this is safe under the mutex
+    BINLOG("\nRead Thread Execution Number: %d\nLatitude: %lf\nLongitude: %lf\nAltitude: %lf",
+           i, state->Latitude, state->Longitude, state->Altitude);
+    BINLOG("\nRoll: %lf\nPitch: %lf\nYaw: %lf\nTimestamp: %lu.%09ld\n",
+           state->Roll, state->Pitch, state->Yaw, state->timestamp.tv_sec, state->timestamp.tv_nsec);
+}
+
 void *update_nav_state(void *threadp) {
     thread_param *tp = (thread_param *)threadp;
+    struct timespec now;
 
     while (!run_complete) {
+        uint64_t start = now_ns(CLOCK_MONOTONIC), locked;
         pthread_mutex_lock(&mutex);
-        nav_state *state = tp->state;
-        clock_gettime(CLOCK_REALTIME, &state->timestamp);
-        state->Latitude = 0.01 * (state->timestamp.tv_sec);
-        state->Longitude = 0.2 * (state->timestamp.tv_sec);
-        state->Altitude = 0.25 * (state->timestamp.tv_sec);
-        state->Roll = sin(2 * PI * (state->timestamp.tv_sec));
-        state->Pitch = cos(2 * PI * (state->timestamp.tv_sec) * (state->timestamp.tv_sec));
-        state->Yaw = cos(2 * PI * (state->timestamp.tv_sec));
+        locked = now_ns(CLOCK_MONOTONIC);
+        hist_record(&tp->stats->lock_wait, locked - start);
+        clock_gettime(CLOCK_REALTIME, &now);
+        nav_state_compute(tp->state, &now);
         pthread_cond_signal(&signal_read);     // Signal read function when update is complete
         pthread_mutex_unlock(&mutex);
-        sleep(1); // Update rate of 1 Hz
+        hist_record(&tp->stats->lock_hold, now_ns(CLOCK_MONOTONIC) - locked);
+        periodic_wait(&update_task); // Update rate set by -r, 1 Hz by default
     }
 
     return NULL;
@@ -66,43 +98,189 @@ void *read_nav_state(void *threadp) {
     thread_param *tp = (thread_param *)threadp;
 
     for (int i = 0; i < 18; i++) {
+        uint64_t start = now_ns(CLOCK_MONOTONIC), locked, signalled;
         pthread_mutex_lock(&mutex);
+        locked = now_ns(CLOCK_MONOTONIC);
+        hist_record(&tp->stats->lock_wait, locked - start);
         pthread_cond_wait(&signal_read, &mutex);  // Wait until update is complete
-        nav_state *state = tp->state;
-        printf("\nRead Thread Execution Number: %d", i);
-        printf("\nLatitude: %lf", state->Latitude);
-        printf("\nLongitude: %lf", state->Longitude);
-        printf("\nAltitude: %lf", state->Altitude);
-        printf("\nRoll: %lf", state->Roll);
-        printf("\nPitch: %lf", state->Pitch);
-        printf("\nYaw: %lf", state->Yaw);
-        printf("\nTimestamp: %lu\n", state->timestamp.tv_sec);
+        signalled = now_ns(CLOCK_MONOTONIC);
+        hist_record(&tp->stats->signal_wait, signalled - locked);
+        nav_stats_age(tp->stats, tp->state);
+        print_nav_state(i, tp->state);
         pthread_mutex_unlock(&mutex);
-        sleep(10); // Read rate of 0.1 Hz
+        hist_record(&tp->stats->lock_hold, now_ns(CLOCK_MONOTONIC) - signalled);
+        periodic_wait(&read_task); // Read rate of 0.1 Hz
+    }
+    run_complete = true;
+    return NULL;
+}
+
+void *update_nav_state_seqlock(void *threadp) {
+    thread_param *tp = (thread_param *)threadp;
+    struct timespec now;
+    nav_state next;
+
+    while (!run_complete) {
+        clock_gettime(CLOCK_REALTIME, &now);
+        nav_state_compute(&next, &now);     // Compute outside of any critical section
+        nav_seqlock_write(tp->pub, &next);
+        periodic_wait(&update_task); // Update rate set by -r, 1 Hz by default
+    }
+
+    return NULL;
+}
+
+void *read_nav_state_seqlock(void *threadp) {
+    thread_param *tp = (thread_param *)threadp;
+    nav_state snapshot;
+
+    for (int i = 0; i < 18; i++) {
+        nav_seqlock_read(tp->pub, &snapshot);
+        nav_stats_age(tp->stats, &snapshot);
+        print_nav_state(i, &snapshot);     // Print from the private copy, nothing is held
+        periodic_wait(&read_task); // Read rate of 0.1 Hz
+    }
+    run_complete = true;
+    return NULL;
+}
+
+void *update_nav_state_ring(void *threadp) {
+    thread_param *tp = (thread_param *)threadp;
+    struct timespec now;
+    nav_state next;
+
+    while (!run_complete) {
+        clock_gettime(CLOCK_REALTIME, &now);
+        nav_state_compute(&next, &now);
+        nav_ring_push(tp->ring, &next);     // Never blocks; a full ring drops the sample
+        periodic_wait(&update_task); // Update rate set by -r, 1 Hz by default
+    }
+
+    return NULL;
+}
+
+void *read_nav_state_ring(void *threadp) {
+    thread_param *tp = (thread_param *)threadp;
+    nav_state batch[NAV_RING_BATCH];
+
+    for (int i = 0; i < 18; i++) {
+        size_t n = nav_ring_pending(tp->ring);  // Drain up to what was there on release, in chunks
+        BINLOG("\n%zu new samples, %zu dropped so far", n, nav_ring_dropped(tp->ring));
+        while (n > 0) {
+            size_t got = nav_ring_drain(tp->ring, batch, n < NAV_RING_BATCH ? n : NAV_RING_BATCH);
+            for (size_t j = 0; j < got; j++) {
+                nav_stats_age(tp->stats, &batch[j]);
+                print_nav_state(i, &batch[j]);
+            }
+            n -= got;
+        }
+        periodic_wait(&read_task); // Read rate of 0.1 Hz
     }
     run_complete = true;
     return NULL;
 }
 
-int main() {
+static void dump_stats(void) {
+    nav_stats_print(stdout, "update", &update_stats);
+    nav_stats_print(stdout, "read", &read_stats);
+    fflush(stdout);
+}
+
+/* Whole of 'arg' as a finite number; false for "", "abc", "5x" or an overflow */
+static bool parse_double(const char *arg, double *out) {
+    char *end;
+
+    *out = strtod(arg, &end);
+    return end != arg && *end == '\0' && isfinite(*out);
+}
+
+int main(int argc, char *argv[]) {
+    pub_mode mode = MODE_MUTEX;
+    nav_shm *shm = NULL;
+    double update_hz = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:r:")) != -1) {
+        if (opt == 'r' && parse_double(optarg, &update_hz) && (update_hz == 0.0 || update_hz >= 1.0)) {
+            continue;   // 0: unthrottled, otherwise from 1 Hz so the period fits in ns
+        } else if (opt == 'm' && strcmp(optarg, "seqlock") == 0) {
+            mode = MODE_SEQLOCK;
+        } else if (opt == 'm' && strcmp(optarg, "ring") == 0) {
+            mode = MODE_RING;
+        } else if (opt == 'm' && strcmp(optarg, "shm") == 0) {
+            mode = MODE_SHM;
+        } else if (opt == 'm' && strcmp(optarg, "mutex") == 0) {
+            mode = MODE_MUTEX;
+        } else {
+            printf("Usage: Q2 [-m mutex|seqlock|ring|shm] [-r update_hz]\n");
+            exit(1);
+        }
+    }
+
     printf("RTES Question 2:\n");
+    nav_stats_init(&update_stats);
+    nav_stats_init(&read_stats);
+    // Before any other thread, so they all inherit the blocked mask
+    if ((errno = stats_signal_start(SIGUSR1, dump_stats)) != 0)
+        perror("stats_signal_start: SIGUSR1 dumps disabled");
+    binlog_init(stdout);
     
     pthread_t threads[NUM_THREADS];
     struct timespec timestamp;
     clock_gettime(CLOCK_REALTIME, &timestamp);
     nav_state state = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, timestamp};
+    nav_seqlock pub = NAV_SEQLOCK_INITIALIZER;
+    nav_seqlock_write(&pub, &state);
+    static nav_ring ring;
      
-    thread_param thread0 = {0, &state}, thread1 = {1, &state};
+    thread_param thread0 = {0, &state, &pub, &ring, &update_stats}, thread1 = {1, &state, &pub, &ring, &read_stats};
+
+    periodic_init(&update_task, update_hz > 0.0 ? (uint64_t)(NSEC_PER_SEC / update_hz) : 0);
+    periodic_init(&read_task, 10 * NSEC_PER_SEC);
 
-    pthread_create(&threads[0], NULL, update_nav_state, (void *)&thread0);
-    pthread_create(&threads[1], NULL, read_nav_state, (void *)&thread1);
+    // Room for every sample between two drains, so the reader sees all of them
+    if (mode == MODE_RING && nav_ring_init(&ring, nav_ring_capacity(update_hz, read_task.period_ns)) != 0) {
+        perror("nav_ring_init");
+        exit(1);
+    }
+
+    if (mode == MODE_SHM) {
+        shm = nav_shm_create(NAV_SHM_NAME, &state);
+        if (shm == NULL) {
+            perror("nav_shm_create");
+            exit(1);
+        }
+        thread0.pub = thread1.pub = &shm->pub;  // The seqlock threads publish straight into the segment
+    }
+
+    if (mode == MODE_SEQLOCK || mode == MODE_SHM) {
+        pthread_create(&threads[0], NULL, update_nav_state_seqlock, (void *)&thread0);
+        pthread_create(&threads[1], NULL, read_nav_state_seqlock, (void *)&thread1);
+    } else if (mode == MODE_RING) {
+        pthread_create(&threads[0], NULL, update_nav_state_ring, (void *)&thread0);
+        pthread_create(&threads[1], NULL, read_nav_state_ring, (void *)&thread1);
+    } else {
+        pthread_create(&threads[0], NULL, update_nav_state, (void *)&thread0);
+        pthread_create(&threads[1], NULL, read_nav_state, (void *)&thread1);
+    }
     
     // Wait for threads to finish
     pthread_join(threads[0], NULL);
     pthread_join(threads[1], NULL);
+    binlog_shutdown();
+    stats_signal_stop();
     
+    periodic_report(stdout, "update_nav_state", &update_task);
+    periodic_report(stdout, "read_nav_state", &read_task);
+    dump_stats();
+#ifdef MUTEX_PROF
+    mutex_prof_report(stdout);
+#endif
+
+    if (shm != NULL)
+        nav_shm_unlink(NAV_SHM_NAME);
+    nav_ring_destroy(&ring);
     pthread_mutex_destroy(&mutex);
 
     return 0;
 }
-
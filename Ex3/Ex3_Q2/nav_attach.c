@@ -0,0 +1,113 @@
+/*
+ * File: nav_attach.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Attaches read-only to the nav_state shared memory segment
+ *		published by "Q2 -m shm" or "Q5 -m shm" and measures, from
+ *		this separate process, how long one snapshot read takes and
+ *		how stale the snapshot is (read time minus sample timestamp).
+ *		Reads run on an absolute-time period set by -p. A read that
+ *		finds the segment stuck mid-write is counted as stale; if the
+ *		writer has also exited, the run stops.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nav_state.h"
+#include "nav_shm.h"
+#include "periodic.h"
+#include "hist.h"
+#include "rt_time.h"
+
+static void usage(void)
+{
+    printf("Usage: nav_attach [-n shm_name] [-d seconds] [-p period_us]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = NAV_SHM_NAME;
+    unsigned duration_s = 10;
+    uint64_t period_ns = 1000 * NSEC_PER_USEC;
+    static hist_t read_lat, staleness;
+    static periodic_task task;
+    const nav_shm *shm;
+    nav_state snapshot = {0}, sample;
+    uint64_t reads = 0, retries = 0, stale_reads = 0, updates_seen = 0, end;
+    unsigned last_version;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:d:p:")) != -1) {
+        switch (opt) {
+        case 'n': name = optarg; break;
+        case 'd': duration_s = (unsigned)atoi(optarg); break;
+        case 'p': period_ns = strtoull(optarg, NULL, 10) * NSEC_PER_USEC; break;
+        default: usage();
+        }
+    }
+    if (duration_s == 0)
+        usage();
+
+    shm = nav_shm_attach(name);
+    if (shm == NULL) {
+        fprintf(stderr, "nav_attach: cannot attach to %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    printf("Attached to %s, writer pid %d, version %u\n", name, (int)shm->writer_pid,
+           nav_shm_version(shm));
+
+    hist_init(&read_lat);
+    hist_init(&staleness);
+    periodic_init(&task, period_ns);
+    last_version = nav_shm_version(shm);
+    end = now_ns(CLOCK_MONOTONIC) + duration_s * NSEC_PER_SEC;
+
+    while (now_ns(CLOCK_MONOTONIC) < end) {
+        uint64_t start = now_ns(CLOCK_MONOTONIC);
+        unsigned version;
+        int rc = nav_shm_read(shm, &sample);
+
+        if (rc < 0) {
+            // Stuck mid-write: a live writer may still finish, a dead one never will
+            stale_reads++;
+            if (kill(shm->writer_pid, 0) != 0 && errno == ESRCH) {
+                fprintf(stderr, "nav_attach: writer pid %d exited in the middle of a write\n",
+                        (int)shm->writer_pid);
+                break;
+            }
+            periodic_wait(&task);
+            continue;
+        }
+        retries += (unsigned)rc;
+        hist_record(&read_lat, now_ns(CLOCK_MONOTONIC) - start);
+        snapshot = sample;      // Only consistent copies are kept
+        hist_record(&staleness, now_ns(CLOCK_REALTIME) - ts_to_ns(&snapshot.timestamp));
+        reads++;
+
+        version = nav_shm_version(shm);
+        updates_seen += version - last_version;
+        last_version = version;
+        periodic_wait(&task);
+    }
+
+    printf("%lu reads, %lu retries, %lu stale reads, %lu updates published during the run\n",
+           (unsigned long)reads, (unsigned long)retries, (unsigned long)stale_reads,
+           (unsigned long)updates_seen);
+    hist_print(stdout, "read latency", &read_lat);
+    hist_print(stdout, "staleness", &staleness);
+    printf("Last snapshot: Latitude %lf Longitude %lf Altitude %lf Timestamp %lu.%09ld\n",
+           snapshot.Latitude, snapshot.Longitude, snapshot.Altitude,
+           snapshot.timestamp.tv_sec, snapshot.timestamp.tv_nsec);
+    periodic_report(stdout, "nav_attach", &task);
+
+    nav_shm_detach(shm);
+    return 0;
+}
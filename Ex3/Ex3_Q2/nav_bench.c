@@ -0,0 +1,333 @@
+/*
+ * File: nav_bench.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Benchmarks for the nav_state publication paths used by Q2
+ *		and Q5.
+ *
+ *		seqlock: compares the mutex + condition variable path against
+ *		the sequence lock path. The writer publishes at a fixed period
+ *		and records how long each publication takes, including any time
+ *		spent blocked on a reader. Readers format each snapshot the way
+ *		read_nav_state does. On the mutex path they wait on signal_read
+ *		for the next update and format while holding the mutex, as
+ *		read_nav_state does; on the seqlock path they read as fast as
+ *		they can.
+ *
+ *		rate: sweeps the update rate from 1 kHz up to unthrottled on one
+ *		publication path and reports the achieved updates/sec, the cost
+ *		of each update and how stale the data is when readers see it.
+ *
+ *		batch: computes a trajectory of timestamps with the scalar
+ *		nav_state_compute loop and with the nav_batch SoA kernel, and
+ *		reports the time per sample and the largest difference per
+ *		column.
+ * Date: 16th October 2026
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nav_state.h"
+#include "nav_seqlock.h"
+#include "nav_batch.h"
+#include "periodic.h"
+#include "hist.h"
+#include "rt_time.h"
+
+#define MAX_READERS 16
+
+typedef enum { PATH_MUTEX, PATH_SEQLOCK } pub_path;
+
+static const char *path_names[] = { "mutex", "seqlock" };
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t signal_read = PTHREAD_COND_INITIALIZER;
+static nav_state state;
+static nav_seqlock pub = NAV_SEQLOCK_INITIALIZER;
+
+static atomic_bool stop;
+static pub_path path;
+static uint64_t period_ns = 100 * NSEC_PER_USEC;
+static unsigned duration_s = 2;
+static int num_readers = 1;
+
+typedef struct {
+    uint64_t publishes;
+    hist_t cost;                /* time to compute and publish one update */
+} writer_result;
+
+typedef struct {
+    uint64_t reads;
+    uint64_t retries;
+    hist_t staleness;           /* read time minus sample timestamp */
+} reader_result;
+
+static writer_result wres;
+static reader_result rres[MAX_READERS];
+
+/* Stand-in for the seven printf calls of read_nav_state */
+static void format_state(const nav_state *s, char *buf, size_t len)
+{
+    snprintf(buf, len, "Lat %lf Lon %lf Alt %lf Roll %lf Pitch %lf Yaw %lf Ts %lu.%09ld\n",
+             s->Latitude, s->Longitude, s->Altitude, s->Roll, s->Pitch, s->Yaw,
+             (unsigned long)s->timestamp.tv_sec, s->timestamp.tv_nsec);
+}
+
+static void *writer(void *arg)
+{
+    periodic_task task;
+    struct timespec now;
+    nav_state next_state;
+
+    (void)arg;
+    periodic_init(&task, period_ns);
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        uint64_t start = now_ns(CLOCK_MONOTONIC);
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        if (path == PATH_MUTEX) {
+            pthread_mutex_lock(&mutex);
+            nav_state_compute(&state, &now);
+            pthread_cond_signal(&signal_read);
+            pthread_mutex_unlock(&mutex);
+        } else {
+            nav_state_compute(&next_state, &now);
+            nav_seqlock_write(&pub, &next_state);
+        }
+
+        hist_record(&wres.cost, now_ns(CLOCK_MONOTONIC) - start);
+        wres.publishes++;
+        periodic_wait(&task);
+    }
+    return NULL;
+}
+
+static void *reader(void *arg)
+{
+    reader_result *res = (reader_result *)arg;
+    nav_state snapshot;
+    char line[256];
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        if (path == PATH_MUTEX) {
+            pthread_mutex_lock(&mutex);
+            // stop is set under the mutex, so checking it here cannot miss the final wakeup
+            if (atomic_load_explicit(&stop, memory_order_relaxed)) {
+                pthread_mutex_unlock(&mutex);
+                break;
+            }
+            pthread_cond_wait(&signal_read, &mutex);  // Wait until update is complete
+            snapshot = state;
+            format_state(&state, line, sizeof(line));
+            pthread_mutex_unlock(&mutex);
+        } else {
+            res->retries += nav_seqlock_read(&pub, &snapshot);
+            format_state(&snapshot, line, sizeof(line));
+        }
+        res->reads++;
+        hist_record(&res->staleness, now_ns(CLOCK_REALTIME) - ts_to_ns(&snapshot.timestamp));
+    }
+    return NULL;
+}
+
+/* Run one writer and num_readers readers on path 'p' for duration_s seconds */
+static void run_path(pub_path p, hist_t *staleness, uint64_t *reads, uint64_t *retries)
+{
+    pthread_t wthread, rthreads[MAX_READERS];
+    struct timespec now;
+
+    path = p;
+    atomic_store(&stop, false);
+    wres.publishes = 0;
+    hist_init(&wres.cost);
+    hist_init(staleness);
+    *reads = *retries = 0;
+
+    /* Readers start from a current sample rather than the epoch */
+    clock_gettime(CLOCK_REALTIME, &now);
+    nav_state_compute(&state, &now);
+    nav_seqlock_write(&pub, &state);
+
+    pthread_create(&wthread, NULL, writer, NULL);
+    for (int i = 0; i < num_readers; i++) {
+        rres[i].reads = rres[i].retries = 0;
+        hist_init(&rres[i].staleness);
+        pthread_create(&rthreads[i], NULL, reader, &rres[i]);
+    }
+
+    sleep(duration_s);
+    pthread_mutex_lock(&mutex);
+    atomic_store(&stop, true);
+    pthread_cond_broadcast(&signal_read);     // Release mutex readers waiting for an update
+    pthread_mutex_unlock(&mutex);
+
+    pthread_join(wthread, NULL);
+    for (int i = 0; i < num_readers; i++) {
+        pthread_join(rthreads[i], NULL);
+        *reads += rres[i].reads;
+        *retries += rres[i].retries;
+        hist_merge(staleness, &rres[i].staleness);
+    }
+}
+
+static void bench_seqlock(void)
+{
+    static hist_t staleness;
+    uint64_t reads, retries;
+
+    printf("writer period %lu us, %d reader(s), %u s per path\n",
+           (unsigned long)(period_ns / NSEC_PER_USEC), num_readers, duration_s);
+    printf("%-8s %10s %14s %14s %14s %14s %10s\n", "path", "publishes",
+           "w_avg_ns", "w_p99_ns", "w_max_ns", "reads/s", "retries");
+    for (pub_path p = PATH_MUTEX; p <= PATH_SEQLOCK; p++) {
+        run_path(p, &staleness, &reads, &retries);
+        printf("%-8s %10lu %14.1f %14lu %14lu %14.0f %10lu\n", path_names[p],
+               (unsigned long)wres.publishes, hist_mean(&wres.cost),
+               (unsigned long)hist_percentile(&wres.cost, 99.0),
+               (unsigned long)atomic_load(&wres.cost.max),
+               (double)reads / duration_s, (unsigned long)retries);
+    }
+}
+
+static void bench_rate(pub_path p)
+{
+    static const unsigned rates_hz[] = { 1000, 10000, 100000, 1000000, 0 };
+    static hist_t staleness;
+    uint64_t reads, retries;
+
+    printf("path %s, %d reader(s), %u s per rate\n", path_names[p], num_readers, duration_s);
+    printf("%10s %12s %12s %12s %12s %12s %12s\n", "target_hz", "updates/s",
+           "cost_avg_ns", "cost_p99_ns", "stale_avg_us", "stale_p99_us", "reads/s");
+    for (size_t i = 0; i < sizeof(rates_hz) / sizeof(rates_hz[0]); i++) {
+        period_ns = rates_hz[i] ? NSEC_PER_SEC / rates_hz[i] : 0;
+        run_path(p, &staleness, &reads, &retries);
+        if (rates_hz[i])
+            printf("%10u", rates_hz[i]);
+        else
+            printf("%10s", "max");
+        printf(" %12.0f %12.1f %12lu %12.1f %12.1f %12.0f\n",
+               (double)wres.publishes / duration_s, hist_mean(&wres.cost),
+               (unsigned long)hist_percentile(&wres.cost, 99.0),
+               hist_mean(&staleness) / 1e3, hist_percentile(&staleness, 99.0) / 1e3,
+               (double)reads / duration_s);
+    }
+}
+
+static double max_diff(const nav_state *aos, const double *col, size_t offset, size_t n)
+{
+    double worst = 0.0;
+
+    for (size_t i = 0; i < n; i++) {
+        double scalar = *(const double *)((const char *)&aos[i] + offset);
+        double d = fabs(scalar - col[i]);
+        if (d > worst)
+            worst = d;
+    }
+    return worst;
+}
+
+static void bench_batch(size_t n)
+{
+    struct timespec *ts = malloc(n * sizeof(*ts));
+    nav_state *aos = malloc(n * sizeof(*aos));
+    nav_batch batch;
+    uint64_t base, start, scalar_ns, batch_ns;
+
+    if (ts == NULL || aos == NULL || nav_batch_init(&batch, n) != 0) {
+        perror("nav_bench batch");
+        exit(1);
+    }
+
+    /* A trajectory sampled every millisecond starting now */
+    base = now_ns(CLOCK_REALTIME);
+    for (size_t i = 0; i < n; i++)
+        ts[i] = ns_to_ts(base + i * NSEC_PER_MSEC);
+
+    /* Touch every page once so neither run pays for first faults */
+    memset(aos, 0, n * sizeof(*aos));
+    nav_batch_compute(&batch, ts, n);
+
+    start = now_ns(CLOCK_MONOTONIC);
+    for (size_t i = 0; i < n; i++)
+        nav_state_compute(&aos[i], &ts[i]);
+    scalar_ns = now_ns(CLOCK_MONOTONIC) - start;
+
+    start = now_ns(CLOCK_MONOTONIC);
+    nav_batch_compute(&batch, ts, n);
+    batch_ns = now_ns(CLOCK_MONOTONIC) - start;
+
+    printf("%zu samples\n", n);
+    printf("%-8s %12s %12s\n", "kernel", "total_ms", "ns/sample");
+    printf("%-8s %12.2f %12.2f\n", "scalar", scalar_ns / 1e6, (double)scalar_ns / n);
+    printf("%-8s %12.2f %12.2f\n", "batch", batch_ns / 1e6, (double)batch_ns / n);
+    printf("speedup %.2fx\n", (double)scalar_ns / batch_ns);
+    printf("max |scalar - batch|: Lat %.3g Lon %.3g Alt %.3g Roll %.3g Pitch %.3g Yaw %.3g\n",
+           max_diff(aos, batch.Latitude, offsetof(nav_state, Latitude), n),
+           max_diff(aos, batch.Longitude, offsetof(nav_state, Longitude), n),
+           max_diff(aos, batch.Altitude, offsetof(nav_state, Altitude), n),
+           max_diff(aos, batch.Roll, offsetof(nav_state, Roll), n),
+           max_diff(aos, batch.Pitch, offsetof(nav_state, Pitch), n),
+           max_diff(aos, batch.Yaw, offsetof(nav_state, Yaw), n));
+
+    nav_batch_destroy(&batch);
+    free(aos);
+    free(ts);
+}
+
+static void usage(void)
+{
+    printf("Usage: nav_bench seqlock [-d seconds] [-r readers] [-p period_us]\n");
+    printf("       nav_bench rate [-d seconds] [-r readers] [-m mutex|seqlock]\n");
+    printf("       nav_bench batch [-n samples]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    pub_path rate_path = PATH_MUTEX;
+    size_t batch_samples = 1000000;
+    int opt;
+
+    if (argc < 2)
+        usage();
+
+    optind = 2;
+    while ((opt = getopt(argc, argv, "d:r:p:m:n:")) != -1) {
+        switch (opt) {
+        case 'd': duration_s = (unsigned)atoi(optarg); break;
+        case 'r': num_readers = atoi(optarg); break;
+        case 'p': period_ns = strtoull(optarg, NULL, 10) * NSEC_PER_USEC; break;
+        case 'n': batch_samples = strtoull(optarg, NULL, 10); break;
+        case 'm':
+            if (strcmp(optarg, "mutex") == 0)
+                rate_path = PATH_MUTEX;
+            else if (strcmp(optarg, "seqlock") == 0)
+                rate_path = PATH_SEQLOCK;
+            else
+                usage();
+            break;
+        default: usage();
+        }
+    }
+    if (num_readers < 1 || num_readers > MAX_READERS || duration_s == 0 || batch_samples == 0)
+        usage();
+
+    if (strcmp(argv[1], "seqlock") == 0)
+        bench_seqlock();
+    else if (strcmp(argv[1], "rate") == 0)
+        bench_rate(rate_path);
+    else if (strcmp(argv[1], "batch") == 0)
+        bench_batch(batch_samples);
+    else
+        usage();
+
+    return 0;
+}
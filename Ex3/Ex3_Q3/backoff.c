@@ -0,0 +1,132 @@
+/*
+ * File: backoff.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Backoff policies, see backoff.h.
+ * Date: 16th October 2026
+ */
+
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#include "backoff.h"
+
+static const char *policy_names[BACKOFF_NUM_POLICIES] = {
+    "uniform", "fixed", "exp", "decorr", "spinyield"
+};
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+void backoff_init(backoff_t *b, backoff_policy policy, uint64_t base_ns, uint64_t cap_ns, uint32_t seed)
+{
+    memset(b, 0, sizeof(*b));
+    b->policy = policy;
+    b->base_ns = base_ns;
+    b->cap_ns = cap_ns > base_ns ? cap_ns : base_ns;
+    b->prev_ns = base_ns;
+    b->rng = seed ? seed : 0x9e3779b9u;
+}
+
+void backoff_reset(backoff_t *b)
+{
+    b->attempt = 0;
+    b->prev_ns = b->base_ns;
+}
+
+uint32_t backoff_rand(backoff_t *b)
+{
+    uint32_t x = b->rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return b->rng = x;
+}
+
+/* Uniform in [lo, hi) */
+static uint64_t rand_between(backoff_t *b, uint64_t lo, uint64_t hi)
+{
+    uint64_t r;
+
+    if (hi <= lo)
+        return lo;
+    r = ((uint64_t)backoff_rand(b) << 32) | backoff_rand(b);
+    return lo + r % (hi - lo);
+}
+
+static uint64_t exp_ceiling(const backoff_t *b, unsigned attempt)
+{
+    if (attempt >= 32 || b->base_ns << attempt >= b->cap_ns)
+        return b->cap_ns;
+    return b->base_ns << attempt;
+}
+
+static void sleep_ns(backoff_t *b, uint64_t ns)
+{
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+
+    b->sleeps++;
+    b->slept_ns += ns;
+    if (ns)
+        nanosleep(&ts, NULL);
+}
+
+void backoff_wait(backoff_t *b)
+{
+    unsigned attempt = b->attempt++;
+
+    b->waits++;
+    switch (b->policy) {
+    case BACKOFF_UNIFORM:
+        sleep_ns(b, rand_between(b, 0, b->cap_ns));
+        break;
+    case BACKOFF_FIXED:
+        sleep_ns(b, b->base_ns);
+        break;
+    case BACKOFF_EXP:
+        sleep_ns(b, rand_between(b, 0, exp_ceiling(b, attempt)));
+        break;
+    case BACKOFF_DECORR:
+        b->prev_ns = rand_between(b, b->base_ns, 3 * b->prev_ns);
+        if (b->prev_ns > b->cap_ns)
+            b->prev_ns = b->cap_ns;
+        sleep_ns(b, b->prev_ns);
+        break;
+    case BACKOFF_SPIN_YIELD:
+        if (attempt < BACKOFF_SPIN_ATTEMPTS) {
+            for (unsigned i = 0; i < 64u << attempt; i++)
+                cpu_relax();
+            b->spins++;
+        } else if (attempt < BACKOFF_SPIN_ATTEMPTS + BACKOFF_YIELD_ATTEMPTS) {
+            sched_yield();
+            b->yields++;
+        } else {
+            sleep_ns(b, rand_between(b, 0, exp_ceiling(b, attempt - BACKOFF_SPIN_ATTEMPTS - BACKOFF_YIELD_ATTEMPTS)));
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int backoff_parse_policy(const char *name)
+{
+    for (int p = 0; p < BACKOFF_NUM_POLICIES; p++)
+        if (strcmp(name, policy_names[p]) == 0)
+            return p;
+    return -1;
+}
+
+const char *backoff_policy_name(backoff_policy policy)
+{
+    return (unsigned)policy < BACKOFF_NUM_POLICIES ? policy_names[policy] : "?";
+}
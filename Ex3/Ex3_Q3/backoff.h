@@ -0,0 +1,69 @@
+/*
+ * File: backoff.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Backoff policies for retrying after a failed
+ *		pthread_mutex_trylock().
+ *
+ *		  uniform     sleep a random time in [0, cap); what deadlock.c
+ *		              did with rand() % 1000 ms
+ *		  fixed       sleep 'base' every time
+ *		  exp         exponential with full jitter: a random time in
+ *		              [0, min(cap, base * 2^attempt))
+ *		  decorr      decorrelated jitter: a random time in
+ *		              [base, 3 * previous), capped at 'cap'
+ *		  spinyield   spin with the CPU's pause hint for a bounded,
+ *		              doubling number of iterations, then yield the
+ *		              CPU a few times, then fall back to exp
+ *
+ *		Each thread owns its backoff_t, which carries its own
+ *		xorshift generator, so there is no shared state and no
+ *		rand() lock to contend on. backoff_reset() after a success
+ *		starts the next wait from the first attempt again.
+ * Date: 16th October 2026
+ */
+
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <stdint.h>
+
+#define BACKOFF_SPIN_ATTEMPTS  6        /* 64 << attempt pause iterations each */
+#define BACKOFF_YIELD_ATTEMPTS 4
+
+typedef enum {
+    BACKOFF_UNIFORM,
+    BACKOFF_FIXED,
+    BACKOFF_EXP,
+    BACKOFF_DECORR,
+    BACKOFF_SPIN_YIELD,
+    BACKOFF_NUM_POLICIES
+} backoff_policy;
+
+typedef struct {
+    backoff_policy policy;
+    uint64_t base_ns, cap_ns;
+    unsigned attempt;               /* failures since the last reset */
+    uint64_t prev_ns;               /* decorr: the previous sleep */
+    uint32_t rng;
+    /* Totals since backoff_init() */
+    uint64_t waits, spins, yields, sleeps;
+    uint64_t slept_ns;              /* requested sleep time */
+} backoff_t;
+
+/* 'seed' only needs to differ between threads; 0 is replaced */
+void backoff_init(backoff_t *b, backoff_policy policy, uint64_t base_ns, uint64_t cap_ns, uint32_t seed);
+
+/* Wait after a failed attempt */
+void backoff_wait(backoff_t *b);
+
+/* The attempt succeeded */
+void backoff_reset(backoff_t *b);
+
+/* Next value of the thread's xorshift32 generator, never 0 */
+uint32_t backoff_rand(backoff_t *b);
+
+/* Policy by name, or -1 if unknown */
+int backoff_parse_policy(const char *name);
+const char *backoff_policy_name(backoff_policy policy);
+
+#endif /* BACKOFF_H */
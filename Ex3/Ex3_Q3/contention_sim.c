@@ -0,0 +1,367 @@
+/*
+ * File: contention_sim.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Lock contention simulator generalizing grabRsrcs() from
+ *		deadlock.c to N threads (-n) and M resources (-m).
+ *
+ *		Every thread repeatedly runs a transaction: it acquires its
+ *		acquisition set of k resources (-k), holds them all for the
+ *		hold time (-h, busy work) and releases them. By default a
+ *		thread's set is fixed at start: threads 2j and 2j+1 share the
+ *		k consecutive resources from (j * k) % m, the even thread
+ *		taking them in ascending order and the odd one in descending
+ *		order, which is the opposite-order pattern of deadlock.c.
+ *		"-r" draws a new random set in random order for every
+ *		transaction instead.
+ *
+ *		Strategies (-s, all of them by default):
+ *		  trylock    lock the first resource, trylock the rest; on
+ *		             EBUSY release everything, back off with policy -B
+ *		             (backoff.h) capped at -b and retry (deadlock.c)
+ *		  ordered    lock the set in global resource order; can
+ *		             neither deadlock nor fail
+ *		  timedlock  lock the first resource, timedlock the rest with
+ *		             a -t timeout; on ETIMEDOUT release everything
+ *		             (an abort), back off as trylock does and retry
+ *		             (deadlock_timeout.c)
+ *		  lockall    lock_all() on the set (lock_all.h): block on
+ *		             one mutex, trylock the rest, and on EBUSY start
+ *		             over by blocking on the busy one; no backoff
+ *		  lockall_timed  lock_all_timed() with a -t timeout; on
+ *		             ETIMEDOUT (an abort) back off and retry
+ *
+ *		Each strategy runs for -d ms and prints one CSV row with the
+ *		transactions completed per second, the retries and aborts,
+ *		and the latency of a transaction from its first attempt to
+ *		its completion. A transaction still retrying at the end of
+ *		the run is dropped. "-S" repeats every strategy for 2, 4, 8
+ *		and 16 threads. Built with -DLOCKDEP, each run starts with an
+ *		empty lock-order graph and its report goes to stderr.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "backoff.h"
+#include "hist.h"
+#include "lock_all.h"
+#include "rt_time.h"
+#include "lockdep.h"   // Lock-order validation when built with -DLOCKDEP
+
+#define MAX_THREADS   64
+#define MAX_RESOURCES 64
+#define BACKOFF_BASE_DIV 16     /* backoff base (first exp step, fixed sleep) is -b / 16 */
+
+typedef enum {
+    STRATEGY_TRYLOCK,
+    STRATEGY_ORDERED,
+    STRATEGY_TIMEDLOCK,
+    STRATEGY_LOCK_ALL,
+    STRATEGY_LOCK_ALL_TIMED,
+    NUM_STRATEGIES
+} strategy_t;
+static const char *strategy_names[NUM_STRATEGIES] = { "trylock", "ordered", "timedlock", "lockall", "lockall_timed" };
+
+static const int sweep_threads[] = { 2, 4, 8, 16 };
+
+typedef struct {
+    int threads, resources, locks;
+    uint64_t hold_ns;
+    backoff_policy backoff;
+    uint64_t backoff_ns;            /* cap of the backoff after a failure, 0 for none */
+    uint64_t timeout_ns;            /* timedlock, lockall_timed */
+    uint64_t duration_ns;
+    bool random_sets;
+} sim_config;
+
+typedef struct {
+    int idx;
+    strategy_t strategy;
+    const sim_config *cfg;
+    uint64_t deadline_ns;
+    backoff_t backoff;              /* also the thread's random generator */
+    int set[MAX_RESOURCES];         /* acquisition order of the current transaction */
+    uint64_t transactions;
+    uint64_t retries;               /* trylock, lockall: attempts started over on EBUSY */
+    uint64_t aborts;                /* timedlock, lockall_timed: attempts given up on ETIMEDOUT */
+    hist_t latency;
+} sim_thread;
+
+static pthread_mutex_t rsrc[MAX_RESOURCES];
+#ifdef LOCKDEP
+static char rsrc_names[MAX_RESOURCES][sizeof "rsrc[-2147483648]"];  /* "rsrc[3]" rather than the expression that locked it */
+#endif
+static sim_thread threads[MAX_THREADS];
+
+/* Stand-in for the work done while holding the resources */
+static void busy_wait(uint64_t ns)
+{
+    uint64_t end = now_ns(CLOCK_MONOTONIC) + ns;
+
+    while (now_ns(CLOCK_MONOTONIC) < end)
+        ;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/* Fill st->set with this transaction's resources in the order the thread wants them */
+static void pick_set(sim_thread *st)
+{
+    const sim_config *cfg = st->cfg;
+
+    if (cfg->random_sets) {
+        int pool[MAX_RESOURCES];
+
+        for (int r = 0; r < cfg->resources; r++)
+            pool[r] = r;
+        for (int i = 0; i < cfg->locks; i++) {      /* partial Fisher-Yates shuffle */
+            int j = i + (int)(backoff_rand(&st->backoff) % (unsigned)(cfg->resources - i));
+            int tmp = pool[i];
+            pool[i] = pool[j];
+            pool[j] = tmp;
+            st->set[i] = pool[i];
+        }
+    } else {
+        int base = (st->idx / 2) * cfg->locks % cfg->resources;
+
+        for (int i = 0; i < cfg->locks; i++) {
+            int r = (base + i) % cfg->resources;
+            st->set[st->idx % 2 ? cfg->locks - 1 - i : i] = r;
+        }
+    }
+    if (st->strategy == STRATEGY_ORDERED)
+        qsort(st->set, (size_t)cfg->locks, sizeof(int), compare_int);
+}
+
+static void release(const int *set, int held)
+{
+    while (held-- > 0)
+        pthread_mutex_unlock(&rsrc[set[held]]);
+}
+
+/* One attempt at the transaction's locks. Returns how many are held: all of them or 0. */
+static int acquire(sim_thread *st)
+{
+    const sim_config *cfg = st->cfg;
+    struct timespec abstime;
+    int held = 0, rc;
+
+    if (st->strategy == STRATEGY_LOCK_ALL || st->strategy == STRATEGY_LOCK_ALL_TIMED) {
+        pthread_mutex_t *set[MAX_RESOURCES];
+        uint64_t restarts = lock_all_restarts();
+
+        for (int i = 0; i < cfg->locks; i++)
+            set[i] = &rsrc[st->set[i]];
+        if (st->strategy == STRATEGY_LOCK_ALL_TIMED) {
+            abstime = ns_to_ts(now_ns(CLOCK_REALTIME) + cfg->timeout_ns);
+            rc = lock_all_timed(set, cfg->locks, &abstime);
+        } else {
+            rc = lock_all(set, cfg->locks);
+        }
+        st->retries += lock_all_restarts() - restarts;
+        if (rc != 0) {
+            st->aborts++;
+            return 0;
+        }
+        return cfg->locks;
+    }
+
+    pthread_mutex_lock(&rsrc[st->set[0]]);
+    held = 1;
+
+    if (st->strategy == STRATEGY_TIMEDLOCK)
+        abstime = ns_to_ts(now_ns(CLOCK_REALTIME) + cfg->timeout_ns);
+
+    for (; held < cfg->locks; held++) {
+        pthread_mutex_t *m = &rsrc[st->set[held]];
+
+        switch (st->strategy) {
+        case STRATEGY_TRYLOCK:
+            rc = pthread_mutex_trylock(m);
+            break;
+        case STRATEGY_TIMEDLOCK:
+            rc = pthread_mutex_timedlock(m, &abstime);
+            break;
+        default:
+            rc = pthread_mutex_lock(m);
+            break;
+        }
+        if (rc != 0) {
+            release(st->set, held);
+            if (rc == ETIMEDOUT)
+                st->aborts++;
+            else
+                st->retries++;
+            return 0;
+        }
+    }
+    return held;
+}
+
+static void *sim_worker(void *arg)
+{
+    sim_thread *st = (sim_thread *)arg;
+    const sim_config *cfg = st->cfg;
+
+    if (!cfg->random_sets)
+        pick_set(st);
+
+    while (now_ns(CLOCK_MONOTONIC) < st->deadline_ns) {
+        uint64_t start = now_ns(CLOCK_MONOTONIC);
+
+        if (cfg->random_sets)
+            pick_set(st);
+        while (acquire(st) == 0) {
+            /* Give up an unfinished transaction at the end of the run */
+            if (now_ns(CLOCK_MONOTONIC) >= st->deadline_ns)
+                return NULL;
+            /* Back off so the other side can finish before we take the first lock again */
+            if (cfg->backoff_ns)
+                backoff_wait(&st->backoff);
+        }
+        backoff_reset(&st->backoff);
+
+        busy_wait(cfg->hold_ns);
+        release(st->set, cfg->locks);
+        hist_record(&st->latency, now_ns(CLOCK_MONOTONIC) - start);
+        st->transactions++;
+    }
+    return NULL;
+}
+
+static void run_strategy(const sim_config *cfg, strategy_t strategy)
+{
+    pthread_t tids[MAX_THREADS];
+    static hist_t latency;
+    uint64_t start, elapsed, transactions = 0, retries = 0, aborts = 0;
+
+    hist_init(&latency);
+    start = now_ns(CLOCK_MONOTONIC);
+    for (int i = 0; i < cfg->threads; i++) {
+        sim_thread *st = &threads[i];
+
+        memset(st, 0, sizeof(*st));
+        st->idx = i;
+        st->strategy = strategy;
+        st->cfg = cfg;
+        st->deadline_ns = start + cfg->duration_ns;
+        backoff_init(&st->backoff, cfg->backoff, cfg->backoff_ns / BACKOFF_BASE_DIV, cfg->backoff_ns,
+                     0x9e3779b9u * (unsigned)(i + 1));
+        hist_init(&st->latency);
+        pthread_create(&tids[i], NULL, sim_worker, st);
+    }
+    for (int i = 0; i < cfg->threads; i++) {
+        pthread_join(tids[i], NULL);
+        transactions += threads[i].transactions;
+        retries += threads[i].retries;
+        aborts += threads[i].aborts;
+        hist_merge(&latency, &threads[i].latency);
+    }
+    elapsed = now_ns(CLOCK_MONOTONIC) - start;
+
+    printf("%s,%d,%d,%d,%.1f,%lu,%.0f,%lu,%lu,%.3f,%.3f,%.3f,%.3f\n",
+           strategy_names[strategy], cfg->threads, cfg->resources, cfg->locks,
+           cfg->hold_ns / 1e3, (unsigned long)transactions, transactions / (elapsed / 1e9),
+           (unsigned long)retries, (unsigned long)aborts,
+           hist_percentile(&latency, 50.0) / 1e3, hist_percentile(&latency, 99.0) / 1e3,
+           hist_percentile(&latency, 99.9) / 1e3, atomic_load(&latency.max) / 1e3);
+    fflush(stdout);
+
+#ifdef LOCKDEP
+    /* Keep the CSV on stdout clean; the next run must not inherit these edges */
+    fprintf(stderr, "lockdep: after %s with %d threads\n", strategy_names[strategy], cfg->threads);
+    lockdep_report(stderr);
+    lockdep_reset();
+#endif
+}
+
+static void usage(void)
+{
+    printf("Usage: contention_sim [-n threads] [-m resources] [-k locks_per_tx] [-h hold_us]\n"
+           "                      [-s trylock|ordered|timedlock|lockall|lockall_timed|all]\n"
+           "                      [-b max_backoff_us] [-B uniform|fixed|exp|decorr|spinyield]\n"
+           "                      [-t timeout_us] [-d ms_per_strategy] [-r] [-S]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    sim_config cfg = {
+        .threads = 4, .resources = 4, .locks = 2,
+        .hold_ns = 10 * NSEC_PER_USEC,
+        .backoff = BACKOFF_UNIFORM,
+        .backoff_ns = 100 * NSEC_PER_USEC,
+        .timeout_ns = 1000 * NSEC_PER_USEC,
+        .duration_ns = 1000 * NSEC_PER_MSEC,
+    };
+    int only = -1, opt;
+    bool sweep = false;
+
+    while ((opt = getopt(argc, argv, "n:m:k:h:s:b:B:t:d:rS")) != -1) {
+        switch (opt) {
+        case 'n': cfg.threads = atoi(optarg); break;
+        case 'm': cfg.resources = atoi(optarg); break;
+        case 'k': cfg.locks = atoi(optarg); break;
+        case 'h': cfg.hold_ns = strtoull(optarg, NULL, 10) * NSEC_PER_USEC; break;
+        case 'b': cfg.backoff_ns = strtoull(optarg, NULL, 10) * NSEC_PER_USEC; break;
+        case 't': cfg.timeout_ns = strtoull(optarg, NULL, 10) * NSEC_PER_USEC; break;
+        case 'd': cfg.duration_ns = strtoull(optarg, NULL, 10) * NSEC_PER_MSEC; break;
+        case 'r': cfg.random_sets = true; break;
+        case 'S': sweep = true; break;
+        case 'B':
+            if ((opt = backoff_parse_policy(optarg)) < 0)
+                usage();
+            cfg.backoff = (backoff_policy)opt;
+            break;
+        case 's':
+            only = NUM_STRATEGIES;
+            for (int s = 0; s < NUM_STRATEGIES; s++)
+                if (strcmp(optarg, strategy_names[s]) == 0)
+                    only = s;
+            if (strcmp(optarg, "all") == 0)
+                only = -1;
+            else if (only == NUM_STRATEGIES)
+                usage();
+            break;
+        default:
+            usage();
+        }
+    }
+    if (cfg.threads < 1 || cfg.threads > MAX_THREADS || cfg.resources < 1 ||
+        cfg.resources > MAX_RESOURCES || cfg.locks < 1 || cfg.locks > cfg.resources ||
+        cfg.duration_ns == 0 || cfg.timeout_ns == 0)
+        usage();
+
+    for (int r = 0; r < cfg.resources; r++) {
+        pthread_mutex_init(&rsrc[r], NULL);
+#ifdef LOCKDEP
+        snprintf(rsrc_names[r], sizeof(rsrc_names[r]), "rsrc[%d]", r);
+        lockdep_set_name(&rsrc[r], rsrc_names[r]);
+#endif
+    }
+
+    printf("strategy,threads,resources,locks_per_tx,hold_us,transactions,tx_per_sec,retries,aborts,"
+           "p50_us,p99_us,p99.9_us,max_us\n");
+    for (size_t n = 0; n < (sweep ? sizeof(sweep_threads) / sizeof(sweep_threads[0]) : 1); n++) {
+        if (sweep)
+            cfg.threads = sweep_threads[n];
+        for (int s = 0; s < NUM_STRATEGIES; s++)
+            if (only < 0 || only == s)
+                run_strategy(&cfg, (strategy_t)s);
+    }
+
+    for (int r = 0; r < cfg.resources; r++)
+        pthread_mutex_destroy(&rsrc[r]);
+    return 0;
+}
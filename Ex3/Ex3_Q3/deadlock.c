@@ -2,6 +2,11 @@
  * File: deadlock.c
  * Author: Krishna Suhagiya and Suhas Reddy
  * Description: This file is modified to fix the deadlock in 'unsafe' option of the 'deadlock' application.
+ *		The trylock path backs off with a per-thread policy from
+ *		backoff.h; "deadlock bench [policy|all] [rounds]" compares the
+ *		policies on the same two-thread opposite-order pattern.
+ *		"deadlock lockall" takes both resources with lock_all()
+ *		instead of the trylock retry loop.
  * Date: 9th March 2023
  */
 
@@ -15,15 +20,41 @@
 #include <stdbool.h>
 #include <errno.h>
 
+#include <stdint.h>
+#include <sys/resource.h>
+
+#include "backoff.h"
+#include "hist.h"
+#include "lock_all.h"
+#include "rt_time.h"
+#include "lockdep.h"   // Lock-order validation when built with -DLOCKDEP
+#include "mutex_prof.h" // Contention profiling when built with -DMUTEX_PROF
+
 #define NUM_THREADS 2
 #define THREAD_1 0
 #define THREAD_2 1
 
+// Benchmark: both threads race for A and B with a short hold between the first lock and the trylock
+#define BENCH_ROUNDS       200
+#define BENCH_HOLD_NS      (100 * NSEC_PER_USEC)
+#define BENCH_BASE_NS      (10 * NSEC_PER_USEC)
+#define BENCH_CAP_NS       (10 * NSEC_PER_MSEC)
+#define BENCH_MAX_ATTEMPTS 1000     // a thread still failing after this many attempts is livelocked
+
 typedef struct
 {
     int threadIdx;
 } threadParams_t;
 
+typedef struct
+{
+    int threadIdx;
+    backoff_t backoff;
+    uint64_t start_ns;
+    uint64_t to_both_ns;    // round start until holding both resources
+    bool livelocked;
+} benchParams_t;
+
 
 pthread_t threads[NUM_THREADS];
 threadParams_t threadParams[NUM_THREADS];
@@ -38,13 +69,37 @@ struct sched_param nrt_param;
 pthread_mutex_t rsrcA = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t rsrcB = PTHREAD_MUTEX_INITIALIZER;
 
-volatile int rsrcACnt=0, rsrcBCnt=0, noWait=0;
+volatile int rsrcACnt=0, rsrcBCnt=0, noWait=0, lockAll=0;
 
 
 void *grabRsrcs(void *threadp)
 {
    threadParams_t *threadParams = (threadParams_t *)threadp;
    int threadIdx = threadParams->threadIdx;
+   backoff_t backoff;
+
+   // Up to a second, as the original rand() % 1000 ms, but from a per-thread generator
+   backoff_init(&backoff, BACKOFF_UNIFORM, 0, NSEC_PER_SEC, (uint32_t)time(NULL) ^ (uint32_t)(threadIdx + 1) * 0x9e3779b9u);
+
+   if(lockAll)  // Both at once, in each thread's own order: no release-and-retry, no sleep(1) per attempt
+   {
+     pthread_mutex_t *rsrcs[2] = { threadIdx == THREAD_1 ? &rsrcA : &rsrcB, threadIdx == THREAD_1 ? &rsrcB : &rsrcA };
+
+     printf("THREAD %d grabbing resources with lock_all\n", threadIdx + 1);
+     if(lock_all(rsrcs, 2) != 0)
+     {
+       printf("THREAD %d ERROR\n", threadIdx + 1);
+       pthread_exit(NULL);
+     }
+     rsrcACnt++;
+     rsrcBCnt++;
+     printf("THREAD %d got A and B after %lu restarts\n", threadIdx + 1, (unsigned long)lock_all_restarts());
+     rsrcACnt--;
+     rsrcBCnt--;
+     unlock_all(rsrcs, 2);
+     printf("THREAD %d done\n", threadIdx + 1);
+     pthread_exit(NULL);
+   }
 
     while(1){
        if(threadIdx == THREAD_1)
@@ -61,8 +116,7 @@ void *grabRsrcs(void *threadp)
           {
             rsrcACnt--;
             pthread_mutex_unlock(&rsrcA);
-            int backoff_time = rand() % 1000;
-            usleep(backoff_time*1000);
+            backoff_wait(&backoff);
           }
           else
           {
@@ -88,8 +142,7 @@ void *grabRsrcs(void *threadp)
           {
             rsrcBCnt--;
             pthread_mutex_unlock(&rsrcB);
-            int backoff_time = rand() % 1000;
-            usleep(backoff_time*1000);
+            backoff_wait(&backoff);
           }
           else
           {
@@ -108,12 +161,150 @@ void *grabRsrcs(void *threadp)
 }
 
 
+// One round of the benchmark: grabRsrcs() without the printing and with a bounded number of attempts
+void *benchGrab(void *threadp)
+{
+   benchParams_t *p = (benchParams_t *)threadp;
+   // Named mutexes rather than pointers, so that lockdep reports rsrcA and rsrcB
+   pthread_mutex_t *first = p->threadIdx == THREAD_1 ? &rsrcA : &rsrcB;
+   struct timespec hold = ns_to_ts(BENCH_HOLD_NS);
+   int rc;
+
+   backoff_reset(&p->backoff);
+   p->livelocked = true;
+   for(int attempt = 0; attempt < BENCH_MAX_ATTEMPTS; attempt++)
+   {
+     if(p->threadIdx == THREAD_1)
+       pthread_mutex_lock(&rsrcA);
+     else
+       pthread_mutex_lock(&rsrcB);
+     nanosleep(&hold, NULL);
+     rc = p->threadIdx == THREAD_1 ? pthread_mutex_trylock(&rsrcB) : pthread_mutex_trylock(&rsrcA);
+     if(rc == EBUSY)
+     {
+       pthread_mutex_unlock(first);
+       backoff_wait(&p->backoff);
+       continue;
+     }
+     p->to_both_ns = now_ns(CLOCK_MONOTONIC) - p->start_ns;
+     p->livelocked = false;
+     pthread_mutex_unlock(&rsrcA);
+     pthread_mutex_unlock(&rsrcB);
+     break;
+   }
+   return NULL;
+}
+
+static double cpu_seconds(void)
+{
+   struct rusage ru;
+
+   getrusage(RUSAGE_SELF, &ru);
+   return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// Livelock rate, time-to-both-resources and CPU burned by one backoff policy
+static void benchPolicy(backoff_policy policy, int rounds)
+{
+   static benchParams_t params[NUM_THREADS];
+   static hist_t toBoth;
+   uint64_t retries = 0;
+   int livelocks = 0, collisions = 0;
+   double cpu;
+
+   hist_init(&toBoth);
+   for(int i = 0; i < NUM_THREADS; i++)
+   {
+     params[i].threadIdx = i;
+     backoff_init(&params[i].backoff, policy, BENCH_BASE_NS, BENCH_CAP_NS, (uint32_t)(i + 1) * 0x9e3779b9u);
+   }
+
+   cpu = cpu_seconds();
+   for(int r = 0; r < rounds; r++)
+   {
+     uint64_t waits[NUM_THREADS];
+
+     for(int i = 0; i < NUM_THREADS; i++)
+     {
+       waits[i] = params[i].backoff.waits;
+       params[i].start_ns = now_ns(CLOCK_MONOTONIC);
+       if(pthread_create(&threads[i], NULL, benchGrab, &params[i]) != 0)
+       {
+         perror("pthread_create");
+         exit(-1);
+       }
+     }
+     for(int i = 0; i < NUM_THREADS; i++)
+     {
+       pthread_join(threads[i], NULL);
+       waits[i] = params[i].backoff.waits - waits[i];
+       retries += waits[i];
+       if(params[i].livelocked)
+         livelocks++;
+       else
+         hist_record(&toBoth, params[i].to_both_ns);
+     }
+     if(waits[THREAD_1] && waits[THREAD_2])
+       collisions++;
+   }
+   cpu = cpu_seconds() - cpu;
+
+   printf("%s,%d,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+          backoff_policy_name(policy), rounds, (double)retries / rounds,
+          100.0 * collisions / rounds, 100.0 * livelocks / (NUM_THREADS * rounds),
+          hist_percentile(&toBoth, 50.0) / 1e3, hist_percentile(&toBoth, 99.0) / 1e3,
+          atomic_load(&toBoth.max) / 1e3, cpu * 1e6 / rounds);
+   fflush(stdout);
+}
+
+static int bench(int argc, char *argv[])
+{
+   int only = -1, rounds = BENCH_ROUNDS;
+
+   if(argc > 2 && strcmp(argv[2], "all") != 0 && (only = backoff_parse_policy(argv[2])) < 0)
+   {
+     printf("Unknown backoff policy %s\n", argv[2]);
+     return 1;
+   }
+   if(argc > 3 && (rounds = atoi(argv[3])) <= 0)
+   {
+     printf("Usage: deadlock bench [uniform|fixed|exp|decorr|spinyield|all] [rounds]\n");
+     return 1;
+   }
+
+   printf("policy,rounds,retries_per_round,both_retried_pct,livelock_pct,to_both_p50_us,to_both_p99_us,to_both_max_us,cpu_us_per_round\n");
+   for(int p = 0; p < BACKOFF_NUM_POLICIES; p++)
+     if(only < 0 || only == p)
+       benchPolicy((backoff_policy)p, rounds);
+
+#ifdef MUTEX_PROF
+   mutex_prof_report(stdout);
+#endif
+#ifdef LOCKDEP
+   lockdep_report(stdout);
+#endif
+   return 0;
+}
+
+
 int main (int argc, char *argv[])
 {
    int rc, safe=0;
 
    rsrcACnt=0, rsrcBCnt=0, noWait=0;
 
+   // Reported as rsrcA/rsrcB even when first locked through a pointer (lock_all, waitgraph)
+#ifdef MUTEX_PROF
+   mutex_prof_set_name(&rsrcA, "rsrcA");
+   mutex_prof_set_name(&rsrcB, "rsrcB");
+#elif defined(LOCKDEP)
+   lockdep_set_name(&rsrcA, "rsrcA");
+   lockdep_set_name(&rsrcB, "rsrcB");
+#endif
+
+   if(argc >= 2 && strcmp(argv[1], "bench") == 0)
+     return bench(argc, argv);
+
    if(argc < 2)
    {
      printf("Will set up unsafe deadlock scenario\n");
@@ -124,16 +315,17 @@ int main (int argc, char *argv[])
        safe=1;
      else if(strncmp("race", argv[1], 4) == 0)
        noWait=1;
+     else if(strncmp("lockall", argv[1], 7) == 0)
+       lockAll=1;
      else
        printf("Will set up unsafe deadlock scenario\n");
    }
    else
    {
-     printf("Usage: deadlock [safe|race|unsafe]\n");
+     printf("Usage: deadlock [safe|race|unsafe|lockall]\n");
+     printf("       deadlock bench [uniform|fixed|exp|decorr|spinyield|all] [rounds]\n");
    }
 
-   srand(time(NULL));
-
    printf("Creating thread %d\n", THREAD_1);
    threadParams[THREAD_1].threadIdx=THREAD_1;
    rc = pthread_create(&threads[0], NULL, grabRsrcs, (void *)&threadParams[THREAD_1]);
@@ -176,6 +368,13 @@ int main (int argc, char *argv[])
    if(pthread_mutex_destroy(&rsrcB) != 0)
      perror("mutex B destroy");
 
+#ifdef MUTEX_PROF
+   mutex_prof_report(stdout);
+#endif
+#ifdef LOCKDEP
+   lockdep_report(stdout);
+#endif
+
    printf("All done\n");
 
    exit(0);
@@ -5,6 +5,11 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#include "lockdep.h"   // Lock-order validation when built with -DLOCKDEP
+#include "mutex_prof.h" // Contention profiling when built with -DMUTEX_PROF
+#include "rt_time.h"
+#include "waitgraph.h"  // Deadlock detection for the 'detect' option
+
 #include <unistd.h>
 #include <string.h>
 
@@ -12,13 +17,16 @@
 #define THREAD_1 1
 #define THREAD_2 2
 
+#define DETECT_PERIOD_NS (1 * NSEC_PER_MSEC)    // wait-for graph scan period
+#define DETECT_SLICE_NS  (1 * NSEC_PER_MSEC)    // timedlock slice between abort checks
+
 typedef struct
 {
     int threadIdx;
 } threadParams_t;
 
 
-threadParams_t threadParams[NUM_THREADS];
+threadParams_t threadParams[NUM_THREADS + 1];  // Indexed by THREAD_1 and THREAD_2
 pthread_t threads[NUM_THREADS];
 struct sched_param nrt_param;
 
@@ -32,6 +40,7 @@ pthread_mutex_t rsrcB = PTHREAD_MUTEX_INITIALIZER;
 
 
 volatile int rsrcACnt=0, rsrcBCnt=0, noWait=0;
+waitgraph_victim victimPolicy = WAITGRAPH_VICTIM_PRIORITY;
 
 
 void *grabRsrcs(void *threadp)
@@ -178,28 +187,118 @@ void *grabRsrcs(void *threadp)
    pthread_exit(NULL);
 }
 
+// 'detect' option: the unsafe scenario without timeouts; the wait-for graph detector breaks the deadlock
+void *grabRsrcsDetect(void *threadp)
+{
+   threadParams_t *threadParams = (threadParams_t *)threadp;
+   int threadIdx = threadParams->threadIdx;
+   pthread_mutex_t *first = threadIdx == THREAD_1 ? &rsrcA : &rsrcB;
+   pthread_mutex_t *second = threadIdx == THREAD_1 ? &rsrcB : &rsrcA;
+   char firstName = threadIdx == THREAD_1 ? 'A' : 'B', secondName = threadIdx == THREAD_1 ? 'B' : 'A';
+   uint64_t start = now_ns(CLOCK_MONOTONIC);
+   int rc, attempt;
+
+   // Thread 2 has the higher priority, Thread 1 has done more work
+   if(waitgraph_register(threadIdx == THREAD_1 ? "Thread1" : "Thread2", threadIdx) != 0)
+   {
+     printf("Thread %d ERROR: wait-for graph full\n", threadIdx);
+     pthread_exit(NULL);
+   }
+   waitgraph_work(threadIdx == THREAD_1 ? 2 : 1);
+
+   for(attempt = 1; ; attempt++)
+   {
+     if((rc = waitgraph_lock(first)) != 0)
+     {
+       printf("Thread %d ERROR %d\n", threadIdx, rc);
+       break;
+     }
+     printf("THREAD %d got %c, trying for %c\n", threadIdx, firstName, secondName);
+
+     // if unsafe test, let the other thread take its first resource
+     if(!noWait && attempt == 1)
+       sleep(1);
+
+     rc = waitgraph_lock(second);
+     if(rc == EDEADLK)
+     {
+       printf("THREAD %d chosen as deadlock victim @ %.1f ms, releasing %c and retrying\n",
+              threadIdx, (now_ns(CLOCK_MONOTONIC) - start) / 1e6, firstName);
+       waitgraph_unlock(first);
+       // Stay out of the way until the survivor has had a chance to take the resource
+       usleep(DETECT_PERIOD_NS / NSEC_PER_USEC);
+       continue;
+     }
+     else if(rc != 0)
+     {
+       printf("Thread %d ERROR %d\n", threadIdx, rc);
+       waitgraph_unlock(first);
+       break;
+     }
+
+     printf("THREAD %d got %c and %c @ %.1f ms on attempt %d\n", threadIdx, firstName, secondName,
+            (now_ns(CLOCK_MONOTONIC) - start) / 1e6, attempt);
+     waitgraph_work(1);
+     waitgraph_unlock(second);
+     waitgraph_unlock(first);
+     printf("THREAD %d done\n", threadIdx);
+     break;
+   }
+
+   waitgraph_unregister();
+   pthread_exit(NULL);
+}
+
 int main (int argc, char *argv[])
 {
-   int rc, safe=0;
+   int rc, safe=0, detect=0;
+   void *(*threadFunc)(void *) = grabRsrcs;
 
    rsrcACnt=0, rsrcBCnt=0, noWait=0;
 
+   // Reported as rsrcA/rsrcB even when first locked through a pointer (lock_all, waitgraph)
+#ifdef MUTEX_PROF
+   mutex_prof_set_name(&rsrcA, "rsrcA");
+   mutex_prof_set_name(&rsrcB, "rsrcB");
+#elif defined(LOCKDEP)
+   lockdep_set_name(&rsrcA, "rsrcA");
+   lockdep_set_name(&rsrcB, "rsrcB");
+#endif
+
    if(argc < 2)
    {
      printf("Will set up unsafe deadlock scenario\n");
    }
-   else if(argc == 2)
+   else if(argc == 2 || (argc == 3 && strncmp("detect", argv[1], 6) == 0))
    {
      if(strncmp("safe", argv[1], 4) == 0)
        safe=1;
      else if(strncmp("race", argv[1], 4) == 0)
        noWait=1;
+     else if(strncmp("detect", argv[1], 6) == 0)
+     {
+       detect=1;
+       if(argc == 3 && strncmp("work", argv[2], 4) == 0)
+         victimPolicy = WAITGRAPH_VICTIM_LEAST_WORK;
+       printf("Will set up unsafe deadlock scenario with the deadlock detector, victim by %s\n",
+              victimPolicy == WAITGRAPH_VICTIM_PRIORITY ? "priority" : "least work");
+     }
      else
        printf("Will set up unsafe deadlock scenario\n");
    }
    else
    {
-     printf("Usage: deadlock [safe|race|unsafe]\n");
+     printf("Usage: deadlock [safe|race|unsafe|detect [priority|work]]\n");
+   }
+
+   if(detect)
+   {
+     threadFunc = grabRsrcsDetect;
+     if((rc = waitgraph_start(victimPolicy, DETECT_PERIOD_NS, DETECT_SLICE_NS)) != 0)
+     {
+       printf("ERROR; waitgraph_start() rc is %d\n", rc);
+       exit(-1);
+     }
    }
 
    // Set default protocol for mutex which is unlocked to start
@@ -213,7 +312,7 @@ int main (int argc, char *argv[])
 
    printf("Creating thread %d\n", THREAD_1);
    threadParams[THREAD_1].threadIdx=THREAD_1;
-   rc = pthread_create(&threads[0], NULL, grabRsrcs, (void *)&threadParams[THREAD_1]);
+   rc = pthread_create(&threads[0], NULL, threadFunc, (void *)&threadParams[THREAD_1]);
    if (rc) {printf("ERROR; pthread_create() rc is %d\n", rc); perror(NULL); exit(-1);}
 
    if(safe) // Make sure Thread 1 finishes with both resources first
@@ -226,7 +325,7 @@ int main (int argc, char *argv[])
 
    printf("Creating thread %d\n", THREAD_2);
    threadParams[THREAD_2].threadIdx=THREAD_2;
-   rc = pthread_create(&threads[1], NULL, grabRsrcs, (void *)&threadParams[THREAD_2]);
+   rc = pthread_create(&threads[1], NULL, threadFunc, (void *)&threadParams[THREAD_2]);
    if (rc) {printf("ERROR; pthread_create() rc is %d\n", rc); perror(NULL); exit(-1);}
 
    printf("will try to join both CS threads unless they deadlock\n");
@@ -252,6 +351,19 @@ int main (int argc, char *argv[])
    if(pthread_mutex_destroy(&rsrcB) != 0)
      perror("mutex B destroy");
 
+   if(detect)
+   {
+     waitgraph_stop();
+     waitgraph_report(stdout);
+   }
+
+#ifdef MUTEX_PROF
+   mutex_prof_report(stdout);
+#endif
+#ifdef LOCKDEP
+   lockdep_report(stdout);
+#endif
+
    printf("All done\n");
 
    exit(0);
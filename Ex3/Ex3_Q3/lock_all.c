@@ -0,0 +1,68 @@
+/*
+ * File: lock_all.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: All-or-nothing mutex set acquisition, see lock_all.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <pthread.h>
+
+#include "lock_all.h"
+#include "lockdep.h"   // Lock-order validation when built with -DLOCKDEP
+#include "mutex_prof.h" // Contention profiling when built with -DMUTEX_PROF
+
+static __thread uint64_t restarts;
+
+/* Unlock the 'count' mutexes starting at index 'first', going round the set */
+static void unlock_from(pthread_mutex_t *const mutexes[], int n, int first, int count)
+{
+    while (count-- > 0)
+        pthread_mutex_unlock(mutexes[(first + count) % n]);
+}
+
+int lock_all_timed(pthread_mutex_t *const mutexes[], int n, const struct timespec *abstime)
+{
+    int first = 0;
+
+    if (n < 1)
+        return EINVAL;
+
+    for (;;) {
+        int rc, k, busy = first;
+
+        rc = abstime ? pthread_mutex_timedlock(mutexes[first], abstime) : pthread_mutex_lock(mutexes[first]);
+        if (rc != 0)
+            return rc;
+
+        for (k = 1; k < n; k++) {
+            busy = (first + k) % n;
+            if ((rc = pthread_mutex_trylock(mutexes[busy])) != 0)
+                break;
+        }
+        if (k == n)
+            return 0;
+
+        unlock_from(mutexes, n, first, k);
+        if (rc != EBUSY)
+            return rc;
+        restarts++;
+        first = busy;   /* wait where the contention is */
+    }
+}
+
+int lock_all(pthread_mutex_t *const mutexes[], int n)
+{
+    return lock_all_timed(mutexes, n, NULL);
+}
+
+void unlock_all(pthread_mutex_t *const mutexes[], int n)
+{
+    while (n-- > 0)
+        pthread_mutex_unlock(mutexes[n]);
+}
+
+uint64_t lock_all_restarts(void)
+{
+    return restarts;
+}
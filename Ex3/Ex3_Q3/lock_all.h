@@ -0,0 +1,42 @@
+/*
+ * File: lock_all.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: All-or-nothing acquisition of a set of mutexes, in the
+ *		manner of std::lock.
+ *
+ *		The thread blocks on one mutex while holding nothing and then
+ *		trylocks the others. If one of them is busy it releases what
+ *		it holds and blocks on that busy one next, instead of spinning
+ *		or sleeping a guessed backoff: the next wait is on the mutex
+ *		that is actually contended, and it ends when its owner lets
+ *		it go. A thread never blocks while holding a mutex of the set,
+ *		so any number of threads may lock overlapping sets in any
+ *		order without deadlock. There is no yield between rounds,
+ *		which under SCHED_FIFO would not let a lower priority owner
+ *		run anyway.
+ *
+ *		The mutexes of a set must be distinct. lock_all_timed() gives
+ *		up at the absolute CLOCK_REALTIME time 'abstime' (as
+ *		pthread_mutex_timedlock) and then holds none of them.
+ * Date: 16th October 2026
+ */
+
+#ifndef LOCK_ALL_H
+#define LOCK_ALL_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Returns 0 with all n mutexes held, or an error with none held */
+int lock_all(pthread_mutex_t *const mutexes[], int n);
+
+/* As lock_all(), or ETIMEDOUT at 'abstime'. A NULL 'abstime' never times out. */
+int lock_all_timed(pthread_mutex_t *const mutexes[], int n, const struct timespec *abstime);
+
+void unlock_all(pthread_mutex_t *const mutexes[], int n);
+
+/* Rounds the calling thread has had to start over because a mutex was busy */
+uint64_t lock_all_restarts(void);
+
+#endif /* LOCK_ALL_H */
@@ -21,6 +21,10 @@
 #include <time.h>
 #include <stdlib.h>
 
+#include "binlog.h"
+#include "lockdep.h"    // Lock-order validation when built with -DLOCKDEP
+#include "mutex_prof.h" // Contention profiling when built with -DMUTEX_PROF
+
 #define NUM_THREADS		4
 #define START_SERVICE 		0
 #define HIGH_PRIO_SERVICE 	1
@@ -82,6 +86,9 @@ int main (int argc, char *argv[])
    fibCycleBurner(47, 2, 1);
    printf("\ndone\n");
 
+   // Service threads log through binlog so printf never runs inside the critical section
+   binlog_init(stdout);
+
    rt_max_prio = sched_get_priority_max(SCHED_FIFO);
    rt_min_prio = sched_get_priority_min(SCHED_FIFO);
 
@@ -164,6 +171,15 @@ int main (int argc, char *argv[])
      perror("START SERVICE");
 
 
+   binlog_shutdown();
+
+#ifdef MUTEX_PROF
+   mutex_prof_report(stdout);
+#endif
+#ifdef LOCKDEP
+   lockdep_report(stdout);
+#endif
+
    if(pthread_mutex_destroy(&sharedMemSem) != 0)
      perror("mutex destroy");
 
@@ -371,19 +387,19 @@ void *simpleTask(void *threadp)
   {
     fibCycleBurner(fibLength, fibComputeSequences, 0);
     idleCount[idleIdx]++;
-    if(idleIdx == LOW_PRIO_SERVICE) printf("L%u ", idleCount[idleIdx]);
-    else if(idleIdx == MID_PRIO_SERVICE) printf("M%u ", idleCount[idleIdx]);
-    else if(idleIdx == HIGH_PRIO_SERVICE) printf("H%u ", idleCount[idleIdx]);
+    if(idleIdx == LOW_PRIO_SERVICE) BINLOG("L%u ", idleCount[idleIdx]);
+    else if(idleIdx == MID_PRIO_SERVICE) BINLOG("M%u ", idleCount[idleIdx]);
+    else if(idleIdx == HIGH_PRIO_SERVICE) BINLOG("H%u ", idleCount[idleIdx]);
   } while(idleCount[idleIdx] < runInterference);
 
   clock_gettime(CLOCK_REALTIME, &timeNow);
 
   if(idleIdx == LOW_PRIO_SERVICE)
-      printf("\n**** LOW PRIO %d on core %d INTERFERE NO SEM COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
+      BINLOG("\n**** LOW PRIO %d on core %d INTERFERE NO SEM COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
   else if(idleIdx == MID_PRIO_SERVICE)
-      printf("\n**** MID PRIO %d on core %d INTERFERE NO SEM COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
+      BINLOG("\n**** MID PRIO %d on core %d INTERFERE NO SEM COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
   else if(idleIdx == HIGH_PRIO_SERVICE)
-      printf("\n**** HIGH PRIO %d on core %d INTERFERE NO SEM COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
+      BINLOG("\n**** HIGH PRIO %d on core %d INTERFERE NO SEM COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
 
   pthread_exit(NULL);
 
@@ -400,16 +416,16 @@ void *criticalSectionTask(void *threadp)
   thread=pthread_self();
   cpucore=sched_getcpu();
 
-  if(idleIdx == LOW_PRIO_SERVICE) printf("\nCS-L REQUEST\n");
-  else if(idleIdx == MID_PRIO_SERVICE) printf("\nCS-M REQUEST\n");
-  else if(idleIdx == HIGH_PRIO_SERVICE) printf("\nCS-H REQUEST\n");
+  if(idleIdx == LOW_PRIO_SERVICE) BINLOG("\nCS-L REQUEST\n");
+  else if(idleIdx == MID_PRIO_SERVICE) BINLOG("\nCS-M REQUEST\n");
+  else if(idleIdx == HIGH_PRIO_SERVICE) BINLOG("\nCS-H REQUEST\n");
 
   pthread_mutex_lock(&sharedMemSem);
   CScnt++;
 
-  if(idleIdx == LOW_PRIO_SERVICE) printf("\nCS-L ENTRY %u\n", CScnt);
-  else if(idleIdx == MID_PRIO_SERVICE) printf("\nCS-M ENTRY %u\n", CScnt);
-  else if(idleIdx == HIGH_PRIO_SERVICE) printf("\nCS-H ENTRY %u\n", CScnt);
+  if(idleIdx == LOW_PRIO_SERVICE) BINLOG("\nCS-L ENTRY %u\n", CScnt);
+  else if(idleIdx == MID_PRIO_SERVICE) BINLOG("\nCS-M ENTRY %u\n", CScnt);
+  else if(idleIdx == HIGH_PRIO_SERVICE) BINLOG("\nCS-H ENTRY %u\n", CScnt);
 
   idleCount[idleIdx]=0;
 
@@ -417,29 +433,29 @@ void *criticalSectionTask(void *threadp)
   {
     fibCycleBurner(fibLength, fibComputeSequences, 0);
     idleCount[idleIdx]++;
-    if(idleIdx == LOW_PRIO_SERVICE) printf("CS-L%u ", idleCount[idleIdx]);
-    else if(idleIdx == MID_PRIO_SERVICE) printf("CS-M%u ", idleCount[idleIdx]);
-    else if(idleIdx == HIGH_PRIO_SERVICE) printf("CS-H%u ", idleCount[idleIdx]);
+    if(idleIdx == LOW_PRIO_SERVICE) BINLOG("CS-L%u ", idleCount[idleIdx]);
+    else if(idleIdx == MID_PRIO_SERVICE) BINLOG("CS-M%u ", idleCount[idleIdx]);
+    else if(idleIdx == HIGH_PRIO_SERVICE) BINLOG("CS-H%u ", idleCount[idleIdx]);
   } while(idleCount[idleIdx] < CS_LENGTH);
 
-  if(idleIdx == LOW_PRIO_SERVICE) printf("\nCS-L LEAVING\n");
-  else if(idleIdx == MID_PRIO_SERVICE) printf("\nCS-M LEAVING\n");
-  else if(idleIdx == HIGH_PRIO_SERVICE) printf("\nCS-H LEAVING\n");
+  if(idleIdx == LOW_PRIO_SERVICE) BINLOG("\nCS-L LEAVING\n");
+  else if(idleIdx == MID_PRIO_SERVICE) BINLOG("\nCS-M LEAVING\n");
+  else if(idleIdx == HIGH_PRIO_SERVICE) BINLOG("\nCS-H LEAVING\n");
 
   pthread_mutex_unlock(&sharedMemSem);
 
-  if(idleIdx == LOW_PRIO_SERVICE) printf("\nCS-L EXIT\n");
-  else if(idleIdx == MID_PRIO_SERVICE) printf("\nCS-M EXIT\n");
-  else if(idleIdx == HIGH_PRIO_SERVICE) printf("\nCS-H EXIT\n");
+  if(idleIdx == LOW_PRIO_SERVICE) BINLOG("\nCS-L EXIT\n");
+  else if(idleIdx == MID_PRIO_SERVICE) BINLOG("\nCS-M EXIT\n");
+  else if(idleIdx == HIGH_PRIO_SERVICE) BINLOG("\nCS-H EXIT\n");
 
   clock_gettime(CLOCK_REALTIME, &timeNow);
 
   if(idleIdx == LOW_PRIO_SERVICE)
-      printf("\n**** LOW PRIO %d on core %d CRIT SECTION WORK COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
+      BINLOG("\n**** LOW PRIO %d on core %d CRIT SECTION WORK COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
   else if(idleIdx == MID_PRIO_SERVICE)
-      printf("\n**** MID PRIO %d on core %d CRIT SECTION WORK COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
+      BINLOG("\n**** MID PRIO %d on core %d CRIT SECTION WORK COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
   else if(idleIdx == HIGH_PRIO_SERVICE)
-      printf("\n**** HIGH PRIO %d on core %d CRIT SECTION WORK COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
+      BINLOG("\n**** HIGH PRIO %d on core %d CRIT SECTION WORK COMPLETED at %lf sec\n", idleIdx, cpucore, dTime(timeNow, timeStartTest));
 
   pthread_exit(NULL);
 
@@ -0,0 +1,307 @@
+/*
+ * File: waitgraph.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Wait-for graph deadlock detector, see waitgraph.h.
+ *
+ *		A waiter publishes the mutex it waits for before it blocks
+ *		and clears it before it records itself as the new owner; an
+ *		owner clears itself before it unlocks. An edge waiter -> owner
+ *		is therefore only ever seen while the owner really holds the
+ *		mutex, never as a thread waiting for itself.
+ *
+ *		The waits on the watched mutexes go through lockdep and
+ *		mutex_prof when those are built in. The detector's own
+ *		table_lock calls the real functions (the parenthesized names
+ *		skip the macros), so it stays out of their reports.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "hist.h"
+#include "periodic.h"
+#include "rt_time.h"
+#include "waitgraph.h"
+#include "lockdep.h"   // Lock-order validation when built with -DLOCKDEP
+#include "mutex_prof.h" // Contention profiling when built with -DMUTEX_PROF
+
+#define NO_THREAD (-1)
+
+typedef struct {
+    atomic_bool used;
+    const char *name;
+    int priority;
+    _Atomic uint64_t work;
+    _Atomic(pthread_mutex_t *) waiting;     /* NULL when not waiting */
+    _Atomic uint64_t wait_seq;              /* bumped by every wait */
+    _Atomic uint64_t wait_start_ns;
+    _Atomic uint64_t abort_seq;             /* the wait to abort, 0 for none */
+} wg_thread;
+
+typedef struct {
+    _Atomic(pthread_mutex_t *) key;
+    atomic_int owner;                       /* NO_THREAD when free or not known */
+} wg_lock;
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+static wg_thread threads[WAITGRAPH_MAX_THREADS];
+static wg_lock locks[WAITGRAPH_MAX_LOCKS];
+static __thread int self = NO_THREAD;
+
+static waitgraph_victim victim_policy;
+static uint64_t slice_ns = NSEC_PER_MSEC;
+static periodic_task scan_period;
+static pthread_t detector;
+static atomic_bool running;
+
+/* Written by the detector only */
+static uint64_t scans, sightings, deadlocks;   /* sightings: cycles seen for the first time */
+static hist_t break_latency;                /* cycle formed -> victim chosen */
+
+/* Slot of 'm', added on first use. NULL when the table is full. */
+static wg_lock *lock_of(pthread_mutex_t *m)
+{
+    wg_lock *l = NULL;
+
+    for (int i = 0; i < WAITGRAPH_MAX_LOCKS; i++) {
+        pthread_mutex_t *key = atomic_load(&locks[i].key);
+        if (key == m)
+            return &locks[i];
+        if (key == NULL)
+            break;
+    }
+
+    (pthread_mutex_lock)(&table_lock);
+    for (int i = 0; i < WAITGRAPH_MAX_LOCKS; i++) {
+        pthread_mutex_t *key = atomic_load(&locks[i].key);
+        if (key == m || key == NULL) {
+            l = &locks[i];
+            if (key == NULL) {
+                atomic_store(&l->owner, NO_THREAD);
+                atomic_store(&l->key, m);
+            }
+            break;
+        }
+    }
+    (pthread_mutex_unlock)(&table_lock);
+    return l;
+}
+
+int waitgraph_register(const char *name, int priority)
+{
+    int rc = ENOSPC;
+
+    (pthread_mutex_lock)(&table_lock);
+    for (int i = 0; i < WAITGRAPH_MAX_THREADS; i++) {
+        wg_thread *t = &threads[i];
+
+        if (atomic_load(&t->used))
+            continue;
+        t->name = name;
+        t->priority = priority;
+        atomic_store(&t->work, 0);
+        atomic_store(&t->waiting, NULL);
+        atomic_store(&t->abort_seq, 0);
+        atomic_store(&t->used, true);
+        self = i;
+        rc = 0;
+        break;
+    }
+    (pthread_mutex_unlock)(&table_lock);
+    return rc;
+}
+
+void waitgraph_unregister(void)
+{
+    if (self != NO_THREAD) {
+        atomic_store(&threads[self].used, false);
+        self = NO_THREAD;
+    }
+}
+
+void waitgraph_work(uint64_t units)
+{
+    if (self != NO_THREAD)
+        atomic_fetch_add_explicit(&threads[self].work, units, memory_order_relaxed);
+}
+
+int waitgraph_lock(pthread_mutex_t *m)
+{
+    wg_lock *l = lock_of(m);
+    wg_thread *t;
+    uint64_t seq;
+    int rc;
+
+    if (self == NO_THREAD || l == NULL)
+        return pthread_mutex_lock(m);
+
+    /* Uncontended: nothing to publish */
+    if ((rc = pthread_mutex_trylock(m)) != EBUSY) {
+        if (rc == 0)
+            atomic_store(&l->owner, self);
+        return rc;
+    }
+
+    t = &threads[self];
+    seq = atomic_fetch_add(&t->wait_seq, 1) + 1;
+    atomic_store(&t->wait_start_ns, now_ns(CLOCK_MONOTONIC));
+    atomic_store(&t->waiting, m);
+    for (;;) {
+        struct timespec abstime = ns_to_ts(now_ns(CLOCK_REALTIME) + slice_ns);
+
+        rc = pthread_mutex_timedlock(m, &abstime);
+        if (rc != ETIMEDOUT)
+            break;
+        if (atomic_load(&t->abort_seq) == seq) {
+            rc = EDEADLK;
+            break;
+        }
+    }
+    atomic_store(&t->waiting, NULL);
+    if (rc == 0)
+        atomic_store(&l->owner, self);
+    return rc;
+}
+
+int waitgraph_unlock(pthread_mutex_t *m)
+{
+    wg_lock *l = lock_of(m);
+
+    if (l != NULL)
+        atomic_store(&l->owner, NO_THREAD);
+    return pthread_mutex_unlock(m);
+}
+
+/* True if 'a' is the better victim */
+static bool better_victim(const wg_thread *a, const wg_thread *b)
+{
+    uint64_t wa = atomic_load(&a->work), wb = atomic_load(&b->work);
+
+    if (victim_policy == WAITGRAPH_VICTIM_PRIORITY && a->priority != b->priority)
+        return a->priority < b->priority;
+    if (wa != wb)
+        return wa < wb;
+    return a->priority < b->priority;
+}
+
+static void scan(void)
+{
+    static uint64_t prev_seq[WAITGRAPH_MAX_THREADS];
+    static uint64_t prev_cycles;            /* bit i: thread i was in a cycle last scan */
+    int next[WAITGRAPH_MAX_THREADS], mark[WAITGRAPH_MAX_THREADS];
+    uint64_t seq[WAITGRAPH_MAX_THREADS], cycles = 0;
+
+    scans++;
+    for (int i = 0; i < WAITGRAPH_MAX_THREADS; i++) {
+        wg_thread *t = &threads[i];
+        pthread_mutex_t *m;
+        wg_lock *l;
+
+        next[i] = NO_THREAD;
+        mark[i] = NO_THREAD;
+        seq[i] = 0;
+        if (!atomic_load(&t->used))
+            continue;
+        seq[i] = atomic_load(&t->wait_seq);
+        if ((m = atomic_load(&t->waiting)) == NULL || (l = lock_of(m)) == NULL)
+            continue;
+        next[i] = atomic_load(&l->owner);
+        if (next[i] == i || atomic_load(&t->wait_seq) != seq[i])
+            next[i] = NO_THREAD;
+    }
+
+    /* Every thread has at most one edge: walk from each one, marking the walk with its start */
+    for (int i = 0; i < WAITGRAPH_MAX_THREADS; i++) {
+        int c = i, head, victim;
+        uint64_t members = 0, formed_ns = 0;
+        bool confirmed = true, pending = false;
+
+        while (c != NO_THREAD && mark[c] == NO_THREAD) {
+            mark[c] = i;
+            c = next[c];
+        }
+        if (c == NO_THREAD || mark[c] != i)
+            continue;   /* no cycle, or one already found from another start */
+
+        head = victim = c;
+        do {
+            wg_thread *t = &threads[c];
+            uint64_t start = atomic_load(&t->wait_start_ns);
+
+            members |= 1ull << c;
+            if (!(prev_cycles & (1ull << c)) || prev_seq[c] != seq[c])
+                confirmed = false;
+            if (atomic_load(&t->abort_seq) == seq[c])
+                pending = true;
+            if (start > formed_ns)
+                formed_ns = start;
+            if (better_victim(t, &threads[victim]))
+                victim = c;
+            c = next[c];
+        } while (c != head);
+        cycles |= members;
+
+        if (pending)
+            continue;   /* already broken, the victim has not woken up yet */
+        if (!confirmed) {
+            sightings++;
+            continue;
+        }
+
+        deadlocks++;
+        hist_record(&break_latency, now_ns(CLOCK_MONOTONIC) - formed_ns);
+        fprintf(stderr, "waitgraph: deadlock among");
+        for (int j = 0; j < WAITGRAPH_MAX_THREADS; j++)
+            if (members & (1ull << j))
+                fprintf(stderr, " %s", threads[j].name);
+        fprintf(stderr, ", aborting the wait of %s (priority %d, work %lu)\n",
+                threads[victim].name, threads[victim].priority,
+                (unsigned long)atomic_load(&threads[victim].work));
+        atomic_store(&threads[victim].abort_seq, seq[victim]);
+    }
+
+    prev_cycles = cycles;
+    memcpy(prev_seq, seq, sizeof(seq));
+}
+
+static void *detector_thread(void *arg)
+{
+    (void)arg;
+    while (atomic_load(&running)) {
+        periodic_wait(&scan_period);
+        scan();
+    }
+    return NULL;
+}
+
+int waitgraph_start(waitgraph_victim policy, uint64_t period_ns, uint64_t slice)
+{
+    int rc;
+
+    victim_policy = policy;
+    slice_ns = slice ? slice : NSEC_PER_MSEC;
+    hist_init(&break_latency);
+    periodic_init(&scan_period, period_ns);
+    atomic_store(&running, true);
+    if ((rc = pthread_create(&detector, NULL, detector_thread, NULL)) != 0)
+        atomic_store(&running, false);
+    return rc;
+}
+
+void waitgraph_stop(void)
+{
+    if (atomic_exchange(&running, false))
+        pthread_join(detector, NULL);
+}
+
+void waitgraph_report(FILE *out)
+{
+    fprintf(out, "waitgraph: %lu scans, %lu cycles sighted, %lu deadlocks confirmed and broken\n",
+            (unsigned long)scans, (unsigned long)sightings, (unsigned long)deadlocks);
+    if (deadlocks)
+        hist_print(out, "waitgraph formed->victim", &break_latency);
+}
@@ -0,0 +1,64 @@
+/*
+ * File: waitgraph.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Wait-for graph deadlock detector with victim selection.
+ *
+ *		Threads that take part register themselves and lock through
+ *		waitgraph_lock()/waitgraph_unlock(). These keep a live record
+ *		of which registered thread owns each mutex and which mutex
+ *		each thread is waiting for. A thread waits for at most one
+ *		mutex, so every thread has at most one outgoing edge
+ *		(waiter -> owner) and a cycle is found by following the edges.
+ *
+ *		A detector thread scans the graph every 'period'. A cycle has
+ *		to be seen in two consecutive scans, with the same waits, to
+ *		count: the records are updated around the lock calls, so a
+ *		single scan can see an owner that has just let go. The
+ *		detector then picks one thread of the cycle as the victim:
+ *		  WAITGRAPH_VICTIM_PRIORITY   the lowest priority (as given to
+ *		                              waitgraph_register), then the
+ *		                              least work
+ *		  WAITGRAPH_VICTIM_LEAST_WORK the least work reported with
+ *		                              waitgraph_work()
+ *		and aborts its wait. Waiting is done in timedlock slices, so
+ *		the victim notices within one slice; its waitgraph_lock()
+ *		returns EDEADLK and it must release what it holds and retry
+ *		or give up. A deadlock is broken within about two periods
+ *		plus a slice, milliseconds rather than a fixed timeout.
+ * Date: 16th October 2026
+ */
+
+#ifndef WAITGRAPH_H
+#define WAITGRAPH_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define WAITGRAPH_MAX_THREADS 64
+#define WAITGRAPH_MAX_LOCKS   64
+
+typedef enum {
+    WAITGRAPH_VICTIM_PRIORITY,
+    WAITGRAPH_VICTIM_LEAST_WORK
+} waitgraph_victim;
+
+/* Start the detector. Returns 0 or an errno value. */
+int waitgraph_start(waitgraph_victim policy, uint64_t period_ns, uint64_t slice_ns);
+void waitgraph_stop(void);
+
+/* Join the graph as the calling thread. Returns 0, or ENOSPC if it is full. */
+int waitgraph_register(const char *name, int priority);
+void waitgraph_unregister(void);
+
+/* Progress made by the calling thread, for WAITGRAPH_VICTIM_LEAST_WORK */
+void waitgraph_work(uint64_t units);
+
+/* Returns 0, EDEADLK if the wait was aborted to break a deadlock, or a pthread error */
+int waitgraph_lock(pthread_mutex_t *m);
+int waitgraph_unlock(pthread_mutex_t *m);
+
+/* Scans, confirmed deadlocks and the time from a cycle forming to its victim being chosen */
+void waitgraph_report(FILE *out);
+
+#endif /* WAITGRAPH_H */
@@ -0,0 +1,108 @@
+/*
+ * File: buf_pool.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Lock-free fixed-size buffer pool, see buf_pool.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "buf_pool.h"
+
+#define POOL_ALIGN 64
+#define HEAD(tag, link) (((uint64_t)(tag) << 32) | (link))
+#define HEAD_LINK(h) ((uint32_t)(h))
+#define HEAD_TAG(h) ((uint32_t)((h) >> 32))
+
+int buf_pool_init(buf_pool *pool, size_t block_size, unsigned count)
+{
+    size_t bytes;
+
+    if (count == 0 || count >= UINT32_MAX || block_size == 0)
+        return EINVAL;
+
+    pool->block_size = (block_size + POOL_ALIGN - 1) & ~(size_t)(POOL_ALIGN - 1);
+    pool->count = count;
+    bytes = pool->block_size * count;
+
+    pool->blocks = aligned_alloc(POOL_ALIGN, bytes);
+    pool->next = malloc(count * sizeof(*pool->next));
+    if (pool->blocks == NULL || pool->next == NULL) {
+        free(pool->blocks);
+        free(pool->next);
+        return ENOMEM;
+    }
+
+    /* Touch every page now rather than on the first message */
+    memset(pool->blocks, 0, bytes);
+    mlock(pool->blocks, bytes);
+
+    for (unsigned i = 0; i < count; i++)
+        atomic_init(&pool->next[i], i + 1 < count ? i + 2 : 0);
+    atomic_init(&pool->head, HEAD(0, 1));
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->high_water, 0);
+    atomic_init(&pool->exhausted, 0);
+    return 0;
+}
+
+void buf_pool_destroy(buf_pool *pool)
+{
+    munlock(pool->blocks, pool->block_size * pool->count);
+    free(pool->blocks);
+    free(pool->next);
+}
+
+void *buf_pool_get(buf_pool *pool)
+{
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint32_t link;
+    unsigned used, high;
+
+    do {
+        link = HEAD_LINK(head);
+        if (link == 0) {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            return NULL;
+        }
+        /* 'next' may be stale if another thread popped this block; the tag check catches it */
+    } while (!atomic_compare_exchange_weak_explicit(
+                 &pool->head, &head,
+                 HEAD(HEAD_TAG(head) + 1,
+                      atomic_load_explicit(&pool->next[link - 1], memory_order_relaxed)),
+                 memory_order_acquire, memory_order_acquire));
+
+    used = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+    high = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    while (used > high &&
+           !atomic_compare_exchange_weak_explicit(&pool->high_water, &high, used,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        ;
+
+    return pool->blocks + (size_t)(link - 1) * pool->block_size;
+}
+
+void buf_pool_put(buf_pool *pool, void *buf)
+{
+    uint32_t link = (uint32_t)(((char *)buf - pool->blocks) / pool->block_size) + 1;
+    uint64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&pool->next[link - 1], HEAD_LINK(head), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                                                    HEAD(HEAD_TAG(head) + 1, link),
+                                                    memory_order_release, memory_order_relaxed));
+
+    atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+}
+
+void buf_pool_report(FILE *out, const char *name, buf_pool *pool)
+{
+    fprintf(out, "%s: %u x %zu byte blocks, %u in use, high water %u, exhausted %lu times\n",
+            name, pool->count, pool->block_size,
+            atomic_load(&pool->in_use), atomic_load(&pool->high_water),
+            (unsigned long)atomic_load(&pool->exhausted));
+}
@@ -0,0 +1,54 @@
+/*
+ * File: buf_pool.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Fixed-size, lock-free buffer pool for message payloads.
+ *
+ *		All blocks are allocated in one region and prefaulted (and
+ *		locked when permitted) at init, so taking or returning a
+ *		block never calls the allocator or faults. Free blocks are
+ *		kept on a Treiber stack of block indices. The stack head packs
+ *		a 32-bit index with a 32-bit tag that changes on every update,
+ *		so a pop that races with pop/push/pop of the same block
+ *		(ABA) fails its compare-and-swap instead of corrupting the
+ *		list. Any thread may get or put.
+ *
+ *		An empty pool makes buf_pool_get() return NULL; these
+ *		exhaustions are counted along with the high-water mark of
+ *		blocks in use.
+ * Date: 16th October 2026
+ */
+
+#ifndef BUF_POOL_H
+#define BUF_POOL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t head;     /* tag << 32 | (index + 1), 0 when empty */
+    _Alignas(64) atomic_uint in_use;
+    atomic_uint high_water;
+    _Atomic uint64_t exhausted;
+
+    size_t block_size;
+    unsigned count;
+    char *blocks;
+    _Atomic uint32_t *next;                 /* index + 1 of the next free block */
+} buf_pool;
+
+/* Allocate and prefault 'count' blocks of 'block_size' bytes. Returns 0 or an errno value. */
+int buf_pool_init(buf_pool *pool, size_t block_size, unsigned count);
+
+void buf_pool_destroy(buf_pool *pool);
+
+/* Take a block, or NULL if the pool is exhausted */
+void *buf_pool_get(buf_pool *pool);
+
+/* Return a block obtained from buf_pool_get() */
+void buf_pool_put(buf_pool *pool, void *buf);
+
+void buf_pool_report(FILE *out, const char *name, buf_pool *pool);
+
+#endif /* BUF_POOL_H */
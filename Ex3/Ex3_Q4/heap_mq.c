@@ -2,9 +2,34 @@
  * File: heap_mq.c
  * Author: Krishna Suhagiya and Suhas Reddy
  * Description: This file ports the provided VxWorks posix_mq.c implementation to POSIX with SCHED_FIFO scheduling.
+ *		Large payload buffers come from a preallocated lock-free pool
+ *		(buf_pool) instead of malloc/free, so neither thread calls the
+ *		allocator.
+ *		Built as heap_shmq (-DSHMQ_REPLACE_MQ) it runs over shmq instead
+ *		of the kernel message queue.
+ *		The sender has its own O_NONBLOCK descriptor and sends through
+ *		mq_tx, so it never blocks on a full queue: "-p" picks the
+ *		drop-newest (default), drop-oldest or coalesce policy, and
+ *		backpressure changes are logged. By default it sends every 3 s
+ *		as before; "-a" paces it adaptively from the queue depth instead
+ *		(AIMD), so it runs as fast as the receiver keeps up. "-n count"
+ *		stops after that many messages and prints the sender statistics.
+ *		Messages are msg_desc descriptors: payloads up to
+ *		MSG_DESC_INLINE_MAX bytes travel inline in the message, larger
+ *		ones ("-l bytes", 64 by default) in a pool block. The receiver
+ *		logs how long each message was queued.
+ *		Queue telemetry (depth, rates, drops, errors and queueing
+ *		latency) is published every 100 ms for mq_stat and printed at
+ *		exit.
+ *		"-P producers -C consumers" runs the multi-producer mode below
+ *		instead, sending "-n" messages per producer (100000 by default)
+ *		and printing one throughput row; "-S" repeats it for 1 up to all
+ *		cores. This mode needs the kernel queues and is not available in
+ *		heap_shmq, whose lanes have a single producer and consumer.
  * Date: 9th March 2023
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
@@ -12,87 +37,182 @@
 #include <string.h>
 #include <unistd.h>
 #include <sched.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef SHMQ_REPLACE_MQ
+#include "shmq.h"   // Same mq_* calls, carried over the shared-memory queue
+#endif
+
+#include "binlog.h"
+#include "buf_pool.h"
+#include "mq_tx.h"
+#include "msg_desc.h"
+#include "mq_telemetry.h"
+#include "rt_time.h"
 
 #define SNDRCV_MQ "/send_receive_mq"
+#define POOL_BLOCKS 128     // More than the queue can hold, plus one in flight on each side
+#define MPMC_MAX_THREADS 64 // Producers or consumers in the multi-producer mode
 
 struct mq_attr mq_attr;
 mqd_t mymq;
+static buf_pool pool;
+
+static mqd_t sendmq;
+static mq_tx tx;
+static mq_tx_policy send_policy = MQ_TX_DROP_NEWEST;
+static int adaptive;
+static unsigned long send_count;   // 0: run forever
+static mq_telemetry_queue *telemetry;
+
+// Messages the sender drops may still own a pool buffer
+static void discard_message(void *ctx, const char *msg, size_t len)
+{
+    msg_desc desc;
+
+    // Anything larger than a descriptor was not packed by us and owns no block
+    if (len > sizeof(desc))
+        return;
+    memcpy(&desc, msg, len);
+    if (msg_desc_valid(&desc, (ssize_t)len))
+        msg_desc_release(&desc, &pool);
+}
 
 void *receiver(void *arg)
 {
-    char buffer[sizeof(void *)+sizeof(int)];
-    void *buffptr;
+    msg_desc desc;
     int prio;
     int nbytes;
-    int id;
 
     while (1)
     {
         /* Read oldest, highest priority msg from the message queue */
-        if ((nbytes = mq_receive(mymq, buffer, (size_t)sizeof(void *)+sizeof(int), &prio)) == -1)
+        if ((nbytes = mq_receive(mymq, (char *)&desc, sizeof(desc), &prio)) == -1)
         {
             perror("mq_receive");
+            mq_telemetry_recv_error(telemetry);
+        }
+        else if (!msg_desc_valid(&desc, nbytes))
+        {
+            BINLOG("receive: malformed message of %d bytes\n", nbytes);
+            mq_telemetry_recv_error(telemetry);
         }
         else
         {
-            buffer[nbytes] = '\0';
-            memcpy(&buffptr, buffer, sizeof(void *));
-            memcpy((void *)&id, &(buffer[sizeof(void *)]), sizeof(int));
-            printf("receive: ptr msg %p received with priority = %d, length = %d, id = %d\n", buffptr, prio, nbytes, id);
-            printf("contents of ptr = %s\n", (char *)buffptr);
-            free(buffptr);
-            printf("heap space memory freed\n");
+            if (desc.hdr.type == MSG_TYPE_STOP)
+                break;      // The sender is done
+            mq_telemetry_received(telemetry, msg_desc_delay_ns(&desc));
+            BINLOG("receive: %s msg received with priority = %d, length = %u, id = %u, queued %lu us\n",
+                   (desc.hdr.flags & MSG_DESC_REF) ? "pooled" : "inline", prio, desc.hdr.length,
+                   desc.hdr.id, (unsigned long)(msg_desc_delay_ns(&desc) / NSEC_PER_USEC));
+            BINLOG("contents = %s\n", (char *)msg_desc_payload(&desc));
+            if (desc.hdr.flags & MSG_DESC_REF)
+            {
+                msg_desc_release(&desc, &pool);
+                BINLOG("buffer returned to pool: %u in use, high water %u, exhausted %lu times\n",
+                       atomic_load(&pool.in_use), atomic_load(&pool.high_water),
+                       (unsigned long)atomic_load(&pool.exhausted));
+            }
         }
     }
     return NULL;
 }
 
 static char imagebuff[4096];
+static char payload[4096];
+static size_t payload_len = 64;    // The first image row; up to MSG_DESC_INLINE_MAX is sent inline
 
 void *sender(void *arg)
 {
-    char buffer[sizeof(void *)+sizeof(int)];
-    void *buffptr;
-    int prio;
-    int nbytes;
-    int id = 999;
+    msg_desc desc;
+    uint32_t id = 999;
+    bool backpressure = false;
+    struct timespec period;
 
-    while (1)
+    for (unsigned long n = 0; send_count == 0 || n < send_count; n++)
     {
-        /* Send malloc'd message with priority=30 */
-        buffptr = (void *)malloc(sizeof(imagebuff));
-        strcpy(buffptr, imagebuff);
-        printf("Message to send = %s\n", (char *)buffptr);
-
-        printf("Sending %ld bytes\n", sizeof(buffptr));
-
-        memcpy(buffer, &buffptr, sizeof(void *));
-        memcpy(&(buffer[sizeof(void *)]), (void *)&id, sizeof(int));
+        uint64_t sent = tx.sent, dropped = tx.dropped_newest + tx.dropped_oldest + tx.coalesced;
 
-        if ((nbytes = mq_send(mymq, buffer, (sizeof(void *) + sizeof(int)), 30)) == -1)
+        /* Send message with priority=30, never blocking on a full queue */
+        if (msg_desc_pack(&desc, MSG_TYPE_IMAGE, id, payload, payload_len, &pool) != 0)
         {
-            perror("mq_send");
+            BINLOG("send: buffer pool exhausted, message dropped\n");
+            mq_telemetry_dropped(telemetry, 1);
         }
         else
         {
-            printf("send: message ptr %p successfully sent\n", buffptr);
+            BINLOG("Message to send = %s\n", (char *)msg_desc_payload(&desc));
+
+            BINLOG("Sending %lu bytes\n", (unsigned long)msg_desc_size(&desc));
+
+            switch (mq_tx_send(&tx, (const char *)&desc, msg_desc_size(&desc), 30))
+            {
+            case MQ_TX_SENT:
+                BINLOG("send: message successfully sent\n");
+                break;
+            case MQ_TX_DROPPED:
+                BINLOG("send: queue full, a message was dropped\n");
+                break;
+            case MQ_TX_PARKED:
+                BINLOG("send: queue full, message parked until there is room\n");
+                break;
+            default:
+                perror("mq_send");
+                msg_desc_release(&desc, &pool);
+                mq_telemetry_send_error(telemetry);
+                break;
+            }
+            // A parked message may have gone out or been replaced as well
+            mq_telemetry_sent(telemetry, tx.sent - sent);
+            mq_telemetry_dropped(telemetry, tx.dropped_newest + tx.dropped_oldest + tx.coalesced - dropped);
+        }
+
+        // Fixed 3 s period, or the AIMD period from the queue depth with -a
+        period = ns_to_ts(mq_tx_pace(&tx));
+        if (mq_tx_backpressure(&tx) != backpressure)
+        {
+            backpressure = !backpressure;
+            BINLOG("send: backpressure %s, period %lu us\n", backpressure ? "on" : "off",
+                   (unsigned long)(tx.period_ns / NSEC_PER_USEC));
         }
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
+    }
 
-        // Introduce a delay
-        usleep(3000000); // 3 seconds
+    // A parked message goes out before the stop, or is counted as dropped
+    uint64_t sent = tx.sent, dropped = tx.dropped_newest;
+    int rc;
 
+    while ((rc = mq_tx_flush(&tx)) == MQ_TX_PARKED)
+    {
+        period = ns_to_ts(tx.period_ns);
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
+    }
+    if (rc == -1)
+    {
+        perror("mq_send");
+        mq_telemetry_send_error(telemetry);
+    }
+    mq_telemetry_sent(telemetry, tx.sent - sent);
+    mq_telemetry_dropped(telemetry, tx.dropped_newest - dropped);
+
+    // Tell the receiver to stop once there is room for it
+    msg_desc_pack(&desc, MSG_TYPE_STOP, id, NULL, 0, NULL);
+    while (mq_send(sendmq, (const char *)&desc, msg_desc_size(&desc), 0) == -1)
+    {
+        period = ns_to_ts(tx.period_ns);
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &period, NULL);
     }
     return NULL;
 }
 
 static int sid, rid;
 
-void heap_mq(void)
+static void fill_image(void)
 {
-    pthread_t receiver_thread, sender_thread;
-    pthread_attr_t receiver_attr, sender_attr;
-    struct sched_param receiver_param, sender_param;
-
     int i, j;
     char pixel = 'A';
 
@@ -105,12 +225,29 @@ void heap_mq(void)
     }
     imagebuff[4095] = '\0';
     imagebuff[63] = '\0';
+}
 
+void heap_mq(void)
+{
+    pthread_t receiver_thread, sender_thread;
+    pthread_attr_t receiver_attr, sender_attr;
+    struct sched_param receiver_param, sender_param;
+    int rc;
+
+    fill_image();
     printf("buffer =\n%s", imagebuff);
+    memcpy(payload, imagebuff, payload_len);
+    payload[payload_len - 1] = '\0';
+
+    if ((rc = buf_pool_init(&pool, sizeof(imagebuff), POOL_BLOCKS)) != 0)
+    {
+        fprintf(stderr, "buf_pool_init: %s\n", strerror(rc));
+        exit(1);
+    }
 
     // Setup common message queue attributes
     mq_attr.mq_maxmsg = 100;
-    mq_attr.mq_msgsize = sizeof(void *)+sizeof(int);
+    mq_attr.mq_msgsize = sizeof(msg_desc);
     mq_attr.mq_flags = 0;
 
     // Initialize attributes
@@ -136,6 +273,30 @@ void heap_mq(void)
         exit(1);
     }
 
+    // The sender gets its own non-blocking descriptor; the receiver keeps blocking
+    sendmq = mq_open(SNDRCV_MQ, O_RDWR | O_NONBLOCK, 777, &mq_attr);
+    if (sendmq == (mqd_t)-1)
+    {
+        perror("sender mq_open");
+        exit(1);
+    }
+    if ((errno = mq_tx_init(&tx, sendmq, send_policy, discard_message, NULL)) != 0)
+    {
+        perror("mq_tx_init");
+        exit(1);
+    }
+    // Published every 100 ms for mq_stat
+    telemetry = mq_telemetry_register("send_receive_mq", sendmq);
+    if ((errno = mq_telemetry_start(MQ_TELEMETRY_SHM, 100 * NSEC_PER_MSEC)) != 0)
+    {
+        perror("mq_telemetry_start");
+        exit(1);
+    }
+    if (adaptive)
+        mq_tx_set_pacing(&tx, NSEC_PER_MSEC, 10 * NSEC_PER_USEC, 3 * NSEC_PER_SEC, 10 * NSEC_PER_USEC);
+    else
+        mq_tx_set_pacing(&tx, 3 * NSEC_PER_SEC, 3 * NSEC_PER_SEC, 3 * NSEC_PER_SEC, 0);
+
     // Create receiver and sender threads with the specified attributes
     if (pthread_create(&receiver_thread, &receiver_attr, receiver, NULL) != 0)
     {
@@ -164,19 +325,303 @@ void heap_mq(void)
     // Wait for threads to complete
     pthread_join(receiver_thread, NULL);
     pthread_join(sender_thread, NULL);
+    binlog_shutdown();     // Flush the thread logs before the reports
+    mq_telemetry_stop();
 
     // Close message queue
+    mq_telemetry_report(stdout, telemetry);
+    mq_tx_report(stdout, "heap_mq sender", &tx);
+    mq_tx_destroy(&tx);
+    mq_close(sendmq);
     mq_close(mymq);
+    buf_pool_report(stdout, "heap_mq pool", &pool);
+    buf_pool_destroy(&pool);
 }
 
+#ifndef SHMQ_REPLACE_MQ
+/*
+ * Multi-producer/multi-consumer mode ("-P producers -C consumers").
+ * Every consumer owns a queue and is pinned to a core. Producer p sends to
+ * the queue of consumer p % C, so with no stealing each producer's messages
+ * arrive in order. A consumer whose own queue is empty takes messages from
+ * the other queues; a stolen message may overtake an older one of the same
+ * producer still waiting in its home queue, and such inversions are counted.
+ * Messages are msg_desc descriptors as in the single pair mode, with the
+ * image in a pool block, the producer in the header's source and its
+ * sequence number in the id.
+ */
+#define MPMC_QUEUE_DEPTH 100   // Lowered to /proc/sys/fs/mqueue/msg_max when that is smaller
+#define MPMC_IDLE_NS (1 * NSEC_PER_MSEC)
+
+typedef struct {
+    int idx;
+    mqd_t own;          // Blocking descriptor for waiting on the own queue
+    mqd_t poll;         // Non-blocking descriptor, also used by thieves
+    uint64_t received;
+    uint64_t stolen;
+} mpmc_consumer;
+
+static mpmc_consumer consumers[MPMC_MAX_THREADS];
+static int mpmc_producers, mpmc_consumers;
+static _Atomic uint32_t delivered_seq[MPMC_MAX_THREADS];   // Highest seq + 1 seen per producer
+static _Atomic uint64_t inversions;
+static _Atomic uint64_t mpmc_remaining;                    // Messages not yet consumed
+
+static void mpmc_queue_name(char *name, size_t len, int idx)
+{
+    snprintf(name, len, "%s_%d", SNDRCV_MQ, idx);
+}
+
+// mq_open fails with EINVAL above msg_max for unprivileged processes
+static long mpmc_queue_depth(void)
+{
+    FILE *f = fopen("/proc/sys/fs/mqueue/msg_max", "r");
+    long depth = MPMC_QUEUE_DEPTH, msg_max;
+
+    if (f != NULL)
+    {
+        if (fscanf(f, "%ld", &msg_max) == 1 && msg_max > 0 && msg_max < depth)
+            depth = msg_max;
+        fclose(f);
+    }
+    return depth;
+}
+
+static void *mpmc_producer(void *arg)
+{
+    int idx = (int)(intptr_t)arg;
+    mqd_t mq = consumers[idx % mpmc_consumers].own;
+    msg_desc desc;
+
+    for (uint32_t seq = 0; seq < send_count; seq++)
+    {
+        // A full pool means the consumers are behind; wait for a buffer
+        while (msg_desc_pack(&desc, MSG_TYPE_IMAGE, seq, imagebuff, sizeof(imagebuff), &pool) != 0)
+            sched_yield();
+        msg_desc_set_source(&desc, (uint32_t)idx);
+        if (mq_send(mq, (const char *)&desc, msg_desc_size(&desc), 30) == -1)
+        {
+            perror("mq_send");
+            exit(1);
+        }
+    }
+    return NULL;
+}
+
+static void mpmc_deliver(mpmc_consumer *self, msg_desc *desc, ssize_t nbytes)
+{
+    uint32_t producer = desc->hdr.source, seq = desc->hdr.id, seen;
+
+    if (!msg_desc_valid(desc, nbytes) || producer >= (uint32_t)mpmc_producers)
+    {
+        fprintf(stderr, "mpmc: malformed message of %zd bytes\n", nbytes);
+        exit(1);
+    }
+
+    // Some later message of this producer was already delivered
+    seen = atomic_load(&delivered_seq[producer]);
+    while (seen <= seq)
+        if (atomic_compare_exchange_weak(&delivered_seq[producer], &seen, seq + 1))
+            break;
+    if (seen > seq)
+        atomic_fetch_add(&inversions, 1);
+
+    msg_desc_release(desc, &pool);
+    self->received++;
+    atomic_fetch_sub(&mpmc_remaining, 1);
+}
+
+static void *mpmc_consumer_thread(void *arg)
+{
+    mpmc_consumer *self = arg;
+    struct timespec deadline;
+    msg_desc desc;
+    ssize_t nbytes;
+    unsigned prio;
+    cpu_set_t cpus;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    CPU_ZERO(&cpus);
+    CPU_SET(self->idx % ncpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    while (atomic_load(&mpmc_remaining) > 0)
+    {
+        if ((nbytes = mq_receive(self->poll, (char *)&desc, sizeof(desc), &prio)) >= 0)
+        {
+            mpmc_deliver(self, &desc, nbytes);
+            continue;
+        }
+
+        // Own queue is empty: steal from the others, starting with the next one
+        bool stole = false;
+        for (int i = 1; i < mpmc_consumers && !stole; i++)
+        {
+            mpmc_consumer *victim = &consumers[(self->idx + i) % mpmc_consumers];
+            if ((nbytes = mq_receive(victim->poll, (char *)&desc, sizeof(desc), &prio)) >= 0)
+            {
+                self->stolen++;
+                mpmc_deliver(self, &desc, nbytes);
+                stole = true;
+            }
+        }
+        if (stole)
+            continue;
+
+        // Nothing anywhere: wait briefly on the own queue, then look again
+        deadline = ns_to_ts(now_ns(CLOCK_REALTIME) + MPMC_IDLE_NS);
+        if ((nbytes = mq_timedreceive(self->own, (char *)&desc, sizeof(desc), &prio, &deadline)) >= 0)
+            mpmc_deliver(self, &desc, nbytes);
+    }
+    return NULL;
+}
+
+// One run with 'producers' x 'consumers' threads; prints one table row
+static void heap_mq_mpmc(int producers, int consumers_count)
+{
+    pthread_t producer_threads[MPMC_MAX_THREADS], consumer_threads[MPMC_MAX_THREADS];
+    struct mq_attr attr = { .mq_maxmsg = mpmc_queue_depth(), .mq_msgsize = sizeof(msg_desc) };
+    char name[64];
+    uint64_t start, elapsed, total, stolen = 0, min_rx = UINT64_MAX, max_rx = 0;
+
+    mpmc_producers = producers;
+    mpmc_consumers = consumers_count;
+    total = (uint64_t)producers * send_count;
+    atomic_store(&mpmc_remaining, total);
+    atomic_store(&inversions, 0);
+    for (int i = 0; i < producers; i++)
+        atomic_store(&delivered_seq[i], 0);
+
+    for (int i = 0; i < consumers_count; i++)
+    {
+        consumers[i] = (mpmc_consumer){ .idx = i };
+        mpmc_queue_name(name, sizeof(name), i);
+        mq_unlink(name);
+        consumers[i].own = mq_open(name, O_CREAT | O_RDWR, 0600, &attr);
+        if (consumers[i].own == (mqd_t)-1)
+        {
+            perror("mq_open");
+            exit(1);
+        }
+        consumers[i].poll = mq_open(name, O_RDWR | O_NONBLOCK, 0600, &attr);
+        if (consumers[i].poll == (mqd_t)-1)
+        {
+            perror("poll mq_open");
+            exit(1);
+        }
+    }
+
+    start = now_ns(CLOCK_MONOTONIC);
+    for (int i = 0; i < consumers_count; i++)
+        pthread_create(&consumer_threads[i], NULL, mpmc_consumer_thread, &consumers[i]);
+    for (int i = 0; i < producers; i++)
+        pthread_create(&producer_threads[i], NULL, mpmc_producer, (void *)(intptr_t)i);
+    for (int i = 0; i < producers; i++)
+        pthread_join(producer_threads[i], NULL);
+    for (int i = 0; i < consumers_count; i++)
+        pthread_join(consumer_threads[i], NULL);
+    elapsed = now_ns(CLOCK_MONOTONIC) - start;
+
+    for (int i = 0; i < consumers_count; i++)
+    {
+        stolen += consumers[i].stolen;
+        min_rx = consumers[i].received < min_rx ? consumers[i].received : min_rx;
+        max_rx = consumers[i].received > max_rx ? consumers[i].received : max_rx;
+        mq_close(consumers[i].own);
+        mq_close(consumers[i].poll);
+        mpmc_queue_name(name, sizeof(name), i);
+        mq_unlink(name);
+    }
+
+    printf("%9d %9d %10lu %12.0f %10lu %10lu %10lu %10lu\n", producers, consumers_count,
+           (unsigned long)total, total / ((double)elapsed / NSEC_PER_SEC),
+           (unsigned long)stolen, (unsigned long)atomic_load(&inversions),
+           (unsigned long)min_rx, (unsigned long)max_rx);
+}
+
+static void heap_mq_mpmc_header(void)
+{
+    printf("%9s %9s %10s %12s %10s %10s %10s %10s\n", "producers", "consumers", "messages",
+           "msgs/s", "stolen", "inversions", "min_rx", "max_rx");
+}
+#endif
+
 void shutdown(void)
 {
   mq_close(mymq);
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    int opt;
+    int producers = 0, consumers_count = 0, sweep = 0;
+
+    while ((opt = getopt(argc, argv, "p:an:l:P:C:S")) != -1)
+    {
+        if (opt == 'p' && mq_tx_parse_policy(optarg, &send_policy) == 0)
+            continue;
+        else if (opt == 'a')
+            adaptive = 1;
+        else if (opt == 'n')
+            send_count = strtoul(optarg, NULL, 10);
+        else if (opt == 'l' && atoi(optarg) > 0 && atoi(optarg) <= (int)sizeof(payload))
+            payload_len = atoi(optarg);
+        else if (opt == 'P' && atoi(optarg) > 0 && atoi(optarg) <= MPMC_MAX_THREADS)
+            producers = atoi(optarg);
+        else if (opt == 'C' && atoi(optarg) > 0 && atoi(optarg) <= MPMC_MAX_THREADS)
+            consumers_count = atoi(optarg);
+        else if (opt == 'S')
+            sweep = 1;
+        else
+        {
+            printf("Usage: heap_mq [-p drop-newest|drop-oldest|coalesce] [-a] [-n count] [-l payload_bytes]\n"
+                   "       heap_mq [-P producers] [-C consumers] [-S] [-n count per producer]\n");
+            exit(1);
+        }
+    }
+
 	mq_unlink(SNDRCV_MQ);  // Make sure that SNDRCV_MQ is cleanly available
+
+    if (producers || consumers_count || sweep)
+    {
+#ifdef SHMQ_REPLACE_MQ
+        printf("heap_shmq: -P, -C and -S need the kernel message queues, use heap_mq\n");
+        exit(1);
+#else
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        int max_consumers = sweep ? (int)(ncpu < MPMC_MAX_THREADS ? ncpu : MPMC_MAX_THREADS) : 0;
+        int rc;
+
+        if (consumers_count > max_consumers)
+            max_consumers = consumers_count;
+        if (max_consumers == 0)
+            max_consumers = consumers_count = 1;
+        if (send_count == 0)
+            send_count = 100000;
+        fill_image();
+
+        // Enough blocks to fill every queue, so producers only wait on mq_send
+        if ((rc = buf_pool_init(&pool, sizeof(imagebuff), max_consumers * mpmc_queue_depth() + MPMC_MAX_THREADS)) != 0)
+        {
+            fprintf(stderr, "buf_pool_init: %s\n", strerror(rc));
+            exit(1);
+        }
+        heap_mq_mpmc_header();
+        if (sweep)
+        {
+            for (int n = 1; n <= max_consumers; n++)
+                heap_mq_mpmc(producers ? producers : n, n);
+        }
+        else
+        {
+            heap_mq_mpmc(producers ? producers : consumers_count, consumers_count ? consumers_count : 1);
+        }
+        buf_pool_destroy(&pool);
+        return 0;
+#endif
+    }
+
+    binlog_init(stdout);   // Sender and receiver log without blocking on stdio
     heap_mq();
     return 0;
 }
@@ -0,0 +1,1094 @@
+/*
+ * File: mq_bench.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: POSIX message queue capacity benchmark.
+ *
+ *		sweep: runs every combination of message size, queue depth
+ *		(mq_maxmsg), producer x consumer thread counts, priority mix
+ *		and scheduling policy for a fixed duration each, and prints
+ *		one CSV row per run. Each row has msgs/sec, the one-way
+ *		latency percentiles (send timestamp to receive), the p99 of
+ *		the high-priority messages alone, and the CPU time per message
+ *		(process user + system time over messages received).
+ *
+ *		Priority mixes: "single" sends everything at priority 1,
+ *		"uniform" spreads messages over priorities 0..31 and "bimodal"
+ *		sends 10% at priority 30 (as heap_mq does) and the rest at 1.
+ *		Messages at priority 16 and above count as high priority.
+ *
+ *		Sizes and depths above /proc/sys/fs/mqueue/msgsize_max and
+ *		msg_max, and SCHED_FIFO runs without the privilege to use it,
+ *		are skipped with a note on stderr.
+ *
+ *		mux: one producer sends round-robin to 1, 16 and 256 queues
+ *		(-n) while the receiving side is either a single mq_mux event
+ *		loop or one blocking receiver thread per queue. Rows report
+ *		msgs/sec, latency, CPU and context switches per message, and
+ *		for mq_mux the messages handled per epoll wakeup. mq_open
+ *		fails with ENOSPC once /proc/sys/fs/mqueue/queues_max (256 by
+ *		default, shared with every other queue) is reached.
+ *
+ *		frag: moves multi-KB records (-l) from a sender to a receiver
+ *		thread either as mq_frag fragments reassembled into
+ *		preallocated buffers, or as heap_mq does: the record is written
+ *		into a buf_pool block and only its pointer and id are queued.
+ *		The receiver reads every byte of each record in both cases.
+ *
+ *		prioq: the heap_mq pointer-passing pattern between threads of
+ *		one process, with 1 and 4 producers (-p) and each priority mix.
+ *		Producers fill a buf_pool block and hand it to one consumer
+ *		either as a pointer and id through mq_send/mq_receive or as the
+ *		block itself through prio_queue. Both get depth + producers + 1
+ *		blocks, so the amount in flight is the same. The depth (-q,
+ *		100 by default) is limited to msg_max. Rows add the
+ *		consumer's futex sleeps and a check that each producer's
+ *		messages of one priority arrive in FIFO order.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hist.h"
+#include "mq_mux.h"
+#include "mq_frag.h"
+#include "buf_pool.h"
+#include "prio_queue.h"
+#include "rt_time.h"
+
+#define BENCH_MQ     "/mq_bench"
+#define MAX_THREADS  16
+#define MAX_LIST     16
+#define HIGH_PRIO    16
+#define PRODUCER_FIFO_PRIO 40
+#define CONSUMER_FIFO_PRIO 50   /* receiver above sender, as in heap_mq */
+
+typedef struct {
+    uint64_t sent_ns;       /* CLOCK_MONOTONIC */
+    uint32_t producer;
+    uint32_t seq;           /* UINT32_MAX: stop message */
+} msg_header;
+
+typedef enum { MIX_SINGLE, MIX_UNIFORM, MIX_BIMODAL } prio_mix;
+static const char *mix_names[] = { "single", "uniform", "bimodal" };
+
+typedef struct {
+    size_t size;
+    long depth;
+    int producers, consumers;
+    prio_mix mix;
+    int policy;
+} bench_config;
+
+typedef struct {
+    const bench_config *cfg;
+    mqd_t mq;
+    int idx;
+    uint64_t deadline_ns;
+    struct timespec send_deadline;  /* the same deadline on CLOCK_REALTIME, for mq_timedsend */
+    uint64_t sent;
+    uint64_t received;
+    int error;              /* consumer: errno of the mq_receive that ended it, 0 if none */
+    hist_t lat;
+    hist_t high_lat;
+} bench_thread;
+
+static bench_thread threads[2 * MAX_THREADS];
+
+static unsigned xorshift32(unsigned *state)
+{
+    unsigned x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static unsigned pick_prio(prio_mix mix, unsigned *rng)
+{
+    switch (mix) {
+    case MIX_UNIFORM: return xorshift32(rng) % 32;
+    case MIX_BIMODAL: return xorshift32(rng) % 10 == 0 ? 30 : 1;
+    default: return 1;
+    }
+}
+
+static void *producer(void *arg)
+{
+    bench_thread *bt = (bench_thread *)arg;
+    char *msg = calloc(1, bt->cfg->size);
+    msg_header *hdr = (msg_header *)msg;
+    unsigned rng = 0x9e3779b9u * (unsigned)(bt->idx + 1);
+
+    hdr->producer = (uint32_t)bt->idx;
+    while ((hdr->sent_ns = now_ns(CLOCK_MONOTONIC)) < bt->deadline_ns) {
+        hdr->seq = (uint32_t)bt->sent;
+        /* Timed, so a producer cannot block forever on a queue nobody drains any more */
+        if (mq_timedsend(bt->mq, msg, bt->cfg->size, pick_prio(bt->cfg->mix, &rng), &bt->send_deadline) == 0)
+            bt->sent++;
+    }
+    free(msg);
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    bench_thread *bt = (bench_thread *)arg;
+    char *msg = malloc(bt->cfg->size);
+    msg_header *hdr = (msg_header *)msg;
+    unsigned prio;
+
+    for (;;) {
+        ssize_t len = mq_receive(bt->mq, msg, bt->cfg->size, &prio);
+
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            bt->error = errno;      /* e.g. EBADF or EMSGSIZE: retrying would only spin */
+            break;
+        }
+        if (len < (ssize_t)sizeof(msg_header))
+            continue;
+        if (hdr->seq == UINT32_MAX)
+            break;
+
+        uint64_t lat = now_ns(CLOCK_MONOTONIC) - hdr->sent_ns;
+        hist_record(&bt->lat, lat);
+        if (prio >= HIGH_PRIO)
+            hist_record(&bt->high_lat, lat);
+        bt->received++;
+    }
+    free(msg);
+    return NULL;
+}
+
+static int start_thread(pthread_t *t, int policy, int prio, void *(*fn)(void *), void *arg)
+{
+    pthread_attr_t attr;
+    struct sched_param param = { .sched_priority = policy == SCHED_FIFO ? prio : 0 };
+    int rc;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, policy);
+    pthread_attr_setschedparam(&attr, &param);
+    rc = pthread_create(t, &attr, fn, arg);
+    pthread_attr_destroy(&attr);
+    return rc;
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static long context_switches(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+/* Run one configuration and print its CSV row. Returns 0, or an errno value if it was skipped. */
+static int run_config(const bench_config *cfg, uint64_t duration_ns)
+{
+    struct mq_attr attr = { .mq_maxmsg = cfg->depth, .mq_msgsize = (long)cfg->size };
+    pthread_t tids[2 * MAX_THREADS];
+    static hist_t lat, high_lat;
+    uint64_t start, elapsed, received = 0;
+    char high_p99[32] = "";
+    double cpu;
+    int n = cfg->producers + cfg->consumers, started = 0, rc = 0;
+    struct timespec send_deadline;
+    mqd_t mq;
+
+    mq_unlink(BENCH_MQ);
+    mq = mq_open(BENCH_MQ, O_CREAT | O_RDWR, 0600, &attr);
+    if (mq == (mqd_t)-1)
+        return errno;
+
+    cpu = cpu_seconds();
+    start = now_ns(CLOCK_MONOTONIC);
+    send_deadline = ns_to_ts(now_ns(CLOCK_REALTIME) + duration_ns);
+    for (int i = 0; i < n && rc == 0; i++) {
+        bench_thread *bt = &threads[i];
+        bool is_consumer = i < cfg->consumers;
+
+        memset(bt, 0, sizeof(*bt));
+        bt->cfg = cfg;
+        bt->mq = mq;
+        bt->idx = is_consumer ? i : i - cfg->consumers;
+        bt->deadline_ns = start + duration_ns;
+        bt->send_deadline = send_deadline;
+        hist_init(&bt->lat);
+        hist_init(&bt->high_lat);
+        rc = start_thread(&tids[i], cfg->policy,
+                          is_consumer ? CONSUMER_FIFO_PRIO : PRODUCER_FIFO_PRIO,
+                          is_consumer ? consumer : producer, bt);
+        if (rc == 0)
+            started++;
+    }
+
+    /* Producers first, then one stop message per consumer at the lowest priority */
+    for (int i = cfg->consumers; i < started; i++)
+        pthread_join(tids[i], NULL);
+    for (int i = 0; i < cfg->consumers && i < started; i++) {
+        msg_header stop = { 0, 0, UINT32_MAX };
+        char *msg = calloc(1, cfg->size);
+        struct timespec stop_deadline = ns_to_ts(now_ns(CLOCK_REALTIME) + NSEC_PER_SEC);
+        memcpy(msg, &stop, sizeof(stop));
+        mq_timedsend(mq, msg, cfg->size, 0, &stop_deadline);   // Consumers that failed leave the queue full
+        free(msg);
+    }
+    for (int i = 0; i < cfg->consumers && i < started; i++) {
+        pthread_join(tids[i], NULL);
+        if (rc == 0)
+            rc = threads[i].error;
+    }
+    elapsed = now_ns(CLOCK_MONOTONIC) - start;
+    cpu = cpu_seconds() - cpu;
+
+    mq_close(mq);
+    mq_unlink(BENCH_MQ);
+    if (rc != 0)
+        return rc;
+
+    hist_init(&lat);
+    hist_init(&high_lat);
+    for (int i = 0; i < n; i++) {
+        received += threads[i].received;
+        hist_merge(&lat, &threads[i].lat);
+        hist_merge(&high_lat, &threads[i].high_lat);
+    }
+
+    /* Left empty when the mix has no high-priority messages */
+    if (hist_count(&high_lat) > 0)
+        snprintf(high_p99, sizeof(high_p99), "%.3f", hist_percentile(&high_lat, 99.0) / 1e3);
+
+    printf("%s,%d,%d,%zu,%ld,%s,%lu,%.0f,%.3f,%.3f,%.3f,%.3f,%s,%.1f\n",
+           cfg->policy == SCHED_FIFO ? "fifo" : "other", cfg->producers, cfg->consumers,
+           cfg->size, cfg->depth, mix_names[cfg->mix], (unsigned long)received,
+           received / (elapsed / 1e9),
+           hist_percentile(&lat, 50.0) / 1e3, hist_percentile(&lat, 99.0) / 1e3,
+           hist_percentile(&lat, 99.9) / 1e3, atomic_load(&lat.max) / 1e3,
+           high_p99,
+           received ? cpu * 1e9 / received : 0.0);
+    fflush(stdout);
+    return 0;
+}
+
+static long read_limit(const char *path, long fallback)
+{
+    FILE *f = fopen(path, "r");
+    long v = fallback;
+
+    if (f != NULL) {
+        if (fscanf(f, "%ld", &v) != 1)
+            v = fallback;
+        fclose(f);
+    }
+    return v;
+}
+
+/* Parse a comma separated list of numbers */
+static int parse_list(const char *s, long *out)
+{
+    int n = 0;
+
+    while (*s && n < MAX_LIST) {
+        char *end;
+        out[n++] = strtol(s, &end, 10);
+        s = *end == ',' ? end + 1 : end;
+        if (end == s && *s)
+            break;
+    }
+    return n;
+}
+
+static void usage(void)
+{
+    printf("Usage: mq_bench sweep [-d ms_per_run] [-s sizes] [-q depths] [-t PxC,...]\n"
+           "                      [-m single,uniform,bimodal] [-P other,fifo]\n"
+           "       mq_bench mux [-d ms_per_run] [-n queue_counts] [-s size] [-q depth] [-b batch]\n"
+           "       mq_bench frag [-d ms_per_run] [-l record_lengths] [-s frame_size] [-q depth]\n"
+           "       mq_bench prioq [-d ms_per_run] [-p producer_counts] [-q depth]\n"
+           "  lists are comma separated, e.g. -s 16,256,4096 -t 1x1,4x4\n");
+    exit(1);
+}
+
+static void bench_sweep(int argc, char *argv[])
+{
+    long sizes[MAX_LIST] = { 16, 64, 256, 1024, 4096, 8192 };
+    long depths[MAX_LIST] = { 1, 10, 100 };
+    long prods[MAX_LIST] = { 1, 2, 1, 4 }, cons[MAX_LIST] = { 1, 1, 2, 4 };
+    int mixes[MAX_LIST] = { MIX_SINGLE, MIX_UNIFORM, MIX_BIMODAL };
+    int policies[2] = { SCHED_OTHER, SCHED_FIFO };
+    int nsizes = 6, ndepths = 3, npairs = 4, nmixes = 3, npolicies = 2;
+    uint64_t duration_ns = 200 * NSEC_PER_MSEC;
+    long max_size = read_limit("/proc/sys/fs/mqueue/msgsize_max", 8192);
+    long max_depth = read_limit("/proc/sys/fs/mqueue/msg_max", 10);
+    char *tok, *save;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:s:q:t:m:P:")) != -1) {
+        switch (opt) {
+        case 'd': duration_ns = strtoull(optarg, NULL, 10) * NSEC_PER_MSEC; break;
+        case 's': nsizes = parse_list(optarg, sizes); break;
+        case 'q': ndepths = parse_list(optarg, depths); break;
+        case 't':
+            npairs = 0;
+            for (tok = strtok_r(optarg, ",", &save); tok && npairs < MAX_LIST; tok = strtok_r(NULL, ",", &save)) {
+                if (sscanf(tok, "%ldx%ld", &prods[npairs], &cons[npairs]) != 2)
+                    usage();
+                npairs++;
+            }
+            break;
+        case 'm':
+            nmixes = 0;
+            for (tok = strtok_r(optarg, ",", &save); tok && nmixes < MAX_LIST; tok = strtok_r(NULL, ",", &save)) {
+                int m;
+                for (m = 0; m < 3 && strcmp(tok, mix_names[m]) != 0; m++)
+                    ;
+                if (m == 3)
+                    usage();
+                mixes[nmixes++] = m;
+            }
+            break;
+        case 'P':
+            npolicies = 0;
+            for (tok = strtok_r(optarg, ",", &save); tok && npolicies < 2; tok = strtok_r(NULL, ",", &save)) {
+                if (strcmp(tok, "other") == 0)
+                    policies[npolicies++] = SCHED_OTHER;
+                else if (strcmp(tok, "fifo") == 0)
+                    policies[npolicies++] = SCHED_FIFO;
+                else
+                    usage();
+            }
+            break;
+        default: usage();
+        }
+    }
+    if (duration_ns == 0)
+        usage();
+
+    printf("policy,producers,consumers,size,depth,prio_mix,msgs,msgs_per_sec,"
+           "p50_us,p99_us,p999_us,max_us,high_p99_us,cpu_ns_per_msg\n");
+
+    for (int p = 0; p < npolicies; p++)
+    for (int t = 0; t < npairs; t++)
+    for (int s = 0; s < nsizes; s++)
+    for (int q = 0; q < ndepths; q++) {
+        bench_config cfg = { (size_t)sizes[s], depths[q], (int)prods[t], (int)cons[t],
+                             MIX_SINGLE, policies[p] };
+
+        if (cfg.size < sizeof(msg_header) || cfg.size > (size_t)max_size || cfg.depth < 1 ||
+            cfg.depth > max_depth || cfg.producers < 1 || cfg.consumers < 1 ||
+            cfg.producers > MAX_THREADS || cfg.consumers > MAX_THREADS) {
+            fprintf(stderr, "skip size %zu depth %ld %dx%d: outside limits (msgsize_max %ld, msg_max %ld)\n",
+                    cfg.size, cfg.depth, cfg.producers, cfg.consumers, max_size, max_depth);
+            continue;
+        }
+        for (int m = 0; m < nmixes; m++) {
+            int rc;
+
+            cfg.mix = (prio_mix)mixes[m];
+            rc = run_config(&cfg, duration_ns);
+            if (rc != 0)
+                fprintf(stderr, "skip %s size %zu depth %ld %dx%d: %s\n",
+                        cfg.policy == SCHED_FIFO ? "fifo" : "other", cfg.size, cfg.depth,
+                        cfg.producers, cfg.consumers, strerror(rc));
+        }
+    }
+}
+
+typedef struct {
+    mqd_t *queues;
+    int nqueues;
+    size_t size;
+    uint64_t deadline_ns;
+    uint64_t sent;
+} mux_producer_arg;
+
+typedef struct {
+    mqd_t mq;
+    size_t size;
+    uint64_t received;
+    int stops;
+    int nqueues;
+    mq_mux *mux;
+    hist_t lat;
+} mux_receiver;
+
+static void *mux_producer(void *arg)
+{
+    mux_producer_arg *pa = (mux_producer_arg *)arg;
+    char *msg = calloc(1, pa->size);
+    msg_header *hdr = (msg_header *)msg;
+
+    while ((hdr->sent_ns = now_ns(CLOCK_MONOTONIC)) < pa->deadline_ns) {
+        hdr->seq = (uint32_t)pa->sent;
+        if (mq_send(pa->queues[pa->sent % pa->nqueues], msg, pa->size, 1) == 0)
+            pa->sent++;
+    }
+
+    hdr->seq = UINT32_MAX;
+    for (int i = 0; i < pa->nqueues; i++)
+        mq_send(pa->queues[i], msg, pa->size, 0);
+    free(msg);
+    return NULL;
+}
+
+static void mux_record(mux_receiver *r, const char *msg)
+{
+    const msg_header *hdr = (const msg_header *)msg;
+
+    if (hdr->seq == UINT32_MAX) {
+        r->stops++;
+        return;
+    }
+    hist_record(&r->lat, now_ns(CLOCK_MONOTONIC) - hdr->sent_ns);
+    r->received++;
+}
+
+static void mux_handler(void *ctx, int queue, const char *msg, size_t len, unsigned prio)
+{
+    mux_receiver *r = (mux_receiver *)ctx;
+
+    mux_record(r, msg);
+    if (r->stops == r->nqueues)
+        mq_mux_stop(r->mux);
+}
+
+static void *mux_loop(void *arg)
+{
+    mq_mux_run(((mux_receiver *)arg)->mux);
+    return NULL;
+}
+
+static void *queue_receiver(void *arg)
+{
+    mux_receiver *r = (mux_receiver *)arg;
+    char *msg = malloc(r->size);
+    unsigned prio;
+
+    while (r->stops == 0) {
+        if (mq_receive(r->mq, msg, r->size, &prio) >= (ssize_t)sizeof(msg_header))
+            mux_record(r, msg);
+    }
+    free(msg);
+    return NULL;
+}
+
+/* One mux run: use_mux selects the event loop or thread-per-queue receivers */
+static int run_mux(bool use_mux, int nqueues, size_t size, long depth, unsigned batch,
+                   uint64_t duration_ns)
+{
+    struct mq_attr attr = { .mq_maxmsg = depth, .mq_msgsize = (long)size };
+    mqd_t *queues = calloc(nqueues, sizeof(mqd_t));
+    mqd_t *senders = calloc(nqueues, sizeof(mqd_t));
+    int nreceivers = use_mux ? 1 : nqueues;
+    mux_receiver *recv = calloc(nreceivers, sizeof(mux_receiver));
+    pthread_t *tids = calloc(nreceivers, sizeof(pthread_t));
+    mux_producer_arg pa = { senders, nqueues, size, 0, 0 };
+    static hist_t lat;
+    pthread_t prod;
+    mq_mux mux;
+    uint64_t start, elapsed, received = 0;
+    long csw;
+    double cpu;
+    char name[32];
+    int rc = 0, opened;
+
+    for (opened = 0; opened < nqueues; opened++) {
+        snprintf(name, sizeof(name), "/mq_bench_mux_%d", opened);
+        mq_unlink(name);
+        queues[opened] = mq_open(name, O_CREAT | O_RDONLY, 0600, &attr);
+        if (queues[opened] == (mqd_t)-1) {
+            rc = errno;
+            break;
+        }
+        /* Separate descriptor: mq_mux makes the receiving one non-blocking */
+        senders[opened] = mq_open(name, O_WRONLY);
+        if (senders[opened] == (mqd_t)-1) {
+            rc = errno;
+            mq_close(queues[opened]);
+            break;
+        }
+    }
+
+    if (rc == 0 && use_mux) {
+        rc = mq_mux_init(&mux, batch);
+        if (rc == 0)
+            recv[0].mux = &mux;     // Also tells the cleanup below to destroy it
+        recv[0].nqueues = nqueues;
+        for (int i = 0; i < nqueues && rc == 0; i++) {
+            if (mq_mux_add(&mux, queues[i], mux_handler, &recv[0]) < 0)
+                rc = errno;
+        }
+    }
+
+    if (rc == 0) {
+        for (int i = 0; i < nreceivers; i++) {
+            recv[i].mq = queues[i];
+            recv[i].size = size;
+            hist_init(&recv[i].lat);
+        }
+
+        cpu = cpu_seconds();
+        csw = context_switches();
+        start = now_ns(CLOCK_MONOTONIC);
+        pa.deadline_ns = start + duration_ns;
+        for (int i = 0; i < nreceivers; i++)
+            pthread_create(&tids[i], NULL, use_mux ? mux_loop : queue_receiver, &recv[i]);
+        pthread_create(&prod, NULL, mux_producer, &pa);
+        pthread_join(prod, NULL);
+        for (int i = 0; i < nreceivers; i++)
+            pthread_join(tids[i], NULL);
+        elapsed = now_ns(CLOCK_MONOTONIC) - start;
+        cpu = cpu_seconds() - cpu;
+        csw = context_switches() - csw;
+
+        hist_init(&lat);
+        for (int i = 0; i < nreceivers; i++) {
+            received += recv[i].received;
+            hist_merge(&lat, &recv[i].lat);
+        }
+        printf("%s,%d,%lu,%.0f,%.3f,%.3f,%.3f,%.3f,%.1f,%.3f,%.2f\n",
+               use_mux ? "mq_mux" : "thread_per_queue", nqueues, (unsigned long)received,
+               received / (elapsed / 1e9),
+               hist_percentile(&lat, 50.0) / 1e3, hist_percentile(&lat, 99.0) / 1e3,
+               hist_percentile(&lat, 99.9) / 1e3, atomic_load(&lat.max) / 1e3,
+               received ? cpu * 1e9 / received : 0.0,
+               received ? (double)csw / received : 0.0,
+               use_mux && mux.wakeups ? (double)mux.messages / mux.wakeups : 1.0);
+        fflush(stdout);
+    }
+
+    if (use_mux && recv[0].mux != NULL)
+        mq_mux_destroy(&mux);
+    for (int i = 0; i < opened; i++) {
+        snprintf(name, sizeof(name), "/mq_bench_mux_%d", i);
+        mq_close(queues[i]);
+        mq_close(senders[i]);
+        mq_unlink(name);
+    }
+    free(queues);
+    free(senders);
+    free(recv);
+    free(tids);
+    return rc;
+}
+
+static void bench_mux(int argc, char *argv[])
+{
+    long counts[MAX_LIST] = { 1, 16, 256 };
+    int ncounts = 3;
+    size_t size = 64;
+    long depth = 10;
+    unsigned batch = 16;
+    uint64_t duration_ns = 500 * NSEC_PER_MSEC;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:n:s:q:b:")) != -1) {
+        switch (opt) {
+        case 'd': duration_ns = strtoull(optarg, NULL, 10) * NSEC_PER_MSEC; break;
+        case 'n': ncounts = parse_list(optarg, counts); break;
+        case 's': size = strtoul(optarg, NULL, 10); break;
+        case 'q': depth = atol(optarg); break;
+        case 'b': batch = (unsigned)atoi(optarg); break;
+        default: usage();
+        }
+    }
+    if (duration_ns == 0 || size < sizeof(msg_header) || depth < 1 || batch == 0)
+        usage();
+
+    printf("receiver,queues,msgs,msgs_per_sec,p50_us,p99_us,p999_us,max_us,"
+           "cpu_ns_per_msg,ctxsw_per_msg,msgs_per_wakeup\n");
+    for (int i = 0; i < ncounts; i++) {
+        for (int use_mux = 1; use_mux >= 0; use_mux--) {
+            int rc = counts[i] > 0 ? run_mux(use_mux, (int)counts[i], size, depth, batch, duration_ns) : EINVAL;
+            if (rc != 0)
+                fprintf(stderr, "skip %s with %ld queues: %s\n",
+                        use_mux ? "mq_mux" : "thread_per_queue", counts[i], strerror(rc));
+        }
+    }
+}
+
+typedef struct {
+    bool use_frag;
+    size_t length;
+    uint64_t deadline_ns;
+    mqd_t mq;
+    mq_frag_tx tx;          /* set up before the threads start, so a failure ends the run */
+    buf_pool *pool;
+    const char *payload;
+    uint64_t sent;
+    uint64_t received;
+    uint64_t checksum;
+    hist_t lat;
+} frag_run;
+
+#define PTR_MSG_SIZE (sizeof(void *) + sizeof(int))
+
+static uint64_t record_sum(const char *data, size_t len)
+{
+    uint64_t sum = 0, w;
+
+    for (size_t i = 0; i + sizeof(w) <= len; i += sizeof(w)) {
+        memcpy(&w, data + i, sizeof(w));
+        sum += w;
+    }
+    return sum;
+}
+
+static void *frag_sender(void *arg)
+{
+    frag_run *fr = (frag_run *)arg;
+    char *record = malloc(fr->length);
+    char msg[PTR_MSG_SIZE];
+    int id = 999;
+
+    memcpy(record, fr->payload, fr->length);
+
+    for (;;) {
+        uint64_t now = now_ns(CLOCK_MONOTONIC);
+        bool stop = now >= fr->deadline_ns;
+
+        if (fr->use_frag) {
+            memcpy(record, &now, sizeof(now));
+            if (mq_frag_send(&fr->tx, record, stop ? 0 : fr->length, 1) == 0 && !stop)
+                fr->sent++;
+        } else {
+            char *buf = stop ? NULL : buf_pool_get(fr->pool);
+            if (buf == NULL && !stop) {
+                sched_yield();
+                continue;
+            }
+            if (buf != NULL) {
+                memcpy(buf, fr->payload, fr->length);      /* build the record in place */
+                memcpy(buf, &now, sizeof(now));
+            }
+            memcpy(msg, &buf, sizeof(void *));
+            memcpy(&msg[sizeof(void *)], &id, sizeof(int));
+            if (mq_send(fr->mq, msg, PTR_MSG_SIZE, 1) == 0 && !stop)
+                fr->sent++;
+        }
+        if (stop)
+            break;
+    }
+
+    free(record);
+    return NULL;
+}
+
+static void *frag_receiver(void *arg)
+{
+    frag_run *fr = (frag_run *)arg;
+    mq_frag_rx rx;
+    char msg[PTR_MSG_SIZE];
+    unsigned prio;
+    uint64_t sent_ns;
+
+    if (fr->use_frag && mq_frag_rx_init(&rx, fr->mq, fr->length, 4) != 0)
+        return NULL;
+
+    for (;;) {
+        char *data;
+        ssize_t len;
+
+        if (fr->use_frag) {
+            len = mq_frag_receive(&rx, (void **)&data, &prio);
+            if (len < 0)
+                continue;
+            if (len == 0)
+                break;
+        } else {
+            if (mq_receive(fr->mq, msg, PTR_MSG_SIZE, &prio) != (ssize_t)PTR_MSG_SIZE)
+                continue;
+            memcpy(&data, msg, sizeof(void *));
+            if (data == NULL)
+                break;
+            len = (ssize_t)fr->length;
+        }
+
+        memcpy(&sent_ns, data, sizeof(sent_ns));
+        fr->checksum += record_sum(data, (size_t)len);
+        hist_record(&fr->lat, now_ns(CLOCK_MONOTONIC) - sent_ns);
+        fr->received++;
+
+        if (fr->use_frag)
+            mq_frag_release(&rx, data);
+        else
+            buf_pool_put(fr->pool, data);
+    }
+
+    if (fr->use_frag) {
+        if (rx.dropped)
+            fprintf(stderr, "frag: %lu records dropped\n", (unsigned long)rx.dropped);
+        mq_frag_rx_destroy(&rx);
+    }
+    return NULL;
+}
+
+static int run_frag(bool use_frag, size_t length, size_t frame, long depth, uint64_t duration_ns)
+{
+    struct mq_attr attr = { .mq_maxmsg = depth,
+                            .mq_msgsize = use_frag ? (long)frame : (long)PTR_MSG_SIZE };
+    static frag_run fr;
+    buf_pool pool;
+    char *payload = malloc(length);
+    pthread_t sender, receiver;
+    uint64_t start, elapsed;
+    double cpu;
+    int rc = 0;
+
+    for (size_t i = 0; i < length; i++)
+        payload[i] = (char)('A' + i % 64);
+
+    memset(&fr, 0, sizeof(fr));
+    fr.use_frag = use_frag;
+    fr.length = length;
+    fr.payload = payload;
+    fr.pool = &pool;
+    hist_init(&fr.lat);
+
+    if (!use_frag && (rc = buf_pool_init(&pool, length, (unsigned)depth + 2)) != 0) {
+        free(payload);
+        return rc;
+    }
+    mq_unlink(BENCH_MQ);
+    fr.mq = mq_open(BENCH_MQ, O_CREAT | O_RDWR, 0600, &attr);
+    if (fr.mq == (mqd_t)-1) {
+        rc = errno;
+    } else if (use_frag && (rc = mq_frag_tx_init(&fr.tx, fr.mq, 1)) != 0) {
+        /* No frame to send from: end the run before a receiver waits on it */
+        mq_close(fr.mq);
+        mq_unlink(BENCH_MQ);
+    } else {
+        cpu = cpu_seconds();
+        start = now_ns(CLOCK_MONOTONIC);
+        fr.deadline_ns = start + duration_ns;
+        pthread_create(&receiver, NULL, frag_receiver, &fr);
+        pthread_create(&sender, NULL, frag_sender, &fr);
+        pthread_join(sender, NULL);
+        pthread_join(receiver, NULL);
+        elapsed = now_ns(CLOCK_MONOTONIC) - start;
+        cpu = cpu_seconds() - cpu;
+
+        printf("%s,%zu,%ld,%lu,%.0f,%.1f,%.3f,%.3f,%.3f,%.1f,%zu\n",
+               use_frag ? "mq_frag" : "pointer", length, attr.mq_msgsize,
+               (unsigned long)fr.received, fr.received / (elapsed / 1e9),
+               fr.received * (double)length / (elapsed / 1e9) / 1e6,
+               hist_percentile(&fr.lat, 50.0) / 1e3, hist_percentile(&fr.lat, 99.0) / 1e3,
+               atomic_load(&fr.lat.max) / 1e3,
+               fr.received ? cpu * 1e9 / fr.received : 0.0,
+               use_frag ? (length + frame - sizeof(mq_frag_hdr) - 1) / (frame - sizeof(mq_frag_hdr)) : 1);
+        fflush(stdout);
+        if (use_frag)
+            mq_frag_tx_destroy(&fr.tx);
+        mq_close(fr.mq);
+        mq_unlink(BENCH_MQ);
+    }
+
+    if (!use_frag)
+        buf_pool_destroy(&pool);
+    free(payload);
+    return rc;
+}
+
+static void bench_frag(int argc, char *argv[])
+{
+    long lengths[MAX_LIST] = { 4096, 16384, 65536 };
+    int nlengths = 3;
+    size_t frame = (size_t)read_limit("/proc/sys/fs/mqueue/msgsize_max", 8192);
+    long depth = 10;
+    uint64_t duration_ns = 500 * NSEC_PER_MSEC;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:l:s:q:")) != -1) {
+        switch (opt) {
+        case 'd': duration_ns = strtoull(optarg, NULL, 10) * NSEC_PER_MSEC; break;
+        case 'l': nlengths = parse_list(optarg, lengths); break;
+        case 's': frame = strtoul(optarg, NULL, 10); break;
+        case 'q': depth = atol(optarg); break;
+        default: usage();
+        }
+    }
+    if (duration_ns == 0 || frame <= sizeof(mq_frag_hdr) || depth < 1)
+        usage();
+
+    printf("method,record_len,msgsize,records,records_per_sec,mb_per_sec,p50_us,p99_us,max_us,"
+           "cpu_ns_per_record,msgs_per_record\n");
+    for (int i = 0; i < nlengths; i++) {
+        for (int use_frag = 1; use_frag >= 0; use_frag--) {
+            int rc = lengths[i] >= (long)sizeof(uint64_t) ?
+                     run_frag(use_frag, (size_t)lengths[i], frame, depth, duration_ns) : EINVAL;
+            if (rc != 0)
+                fprintf(stderr, "skip %s with %ld byte records: %s\n",
+                        use_frag ? "mq_frag" : "pointer", lengths[i], strerror(rc));
+        }
+    }
+}
+
+typedef struct {
+    prio_queue_node node;   /* must stay first: prio_queue hands back this address */
+    uint64_t sent_ns;
+    uint32_t producer;
+    uint32_t seq;
+    char payload[64];
+} prioq_block;
+
+typedef struct {
+    bool use_prioq;
+    int producers;
+    prio_mix mix;
+    uint64_t deadline_ns;
+    mqd_t mq;
+    prio_queue *pq;
+    buf_pool *pool;
+    uint64_t sent[MAX_THREADS];
+    uint64_t received;
+    uint64_t order_errors;      /* FIFO violations within one producer and priority */
+    hist_t lat;
+    hist_t high_lat;
+} prioq_run;
+
+typedef struct {
+    prioq_run *run;
+    int idx;
+} prioq_producer_arg;
+
+static prioq_block prioq_stop[MAX_THREADS];
+
+/* Hand one block to the consumer, as heap_mq does: a pointer and an id, or the node itself */
+static int prioq_send(prioq_run *run, prioq_block *blk, unsigned prio)
+{
+    char msg[PTR_MSG_SIZE];
+    int id = 999;
+
+    if (run->use_prioq)
+        return prio_queue_push(run->pq, &blk->node, prio);
+    memcpy(msg, &blk, sizeof(void *));
+    memcpy(&msg[sizeof(void *)], &id, sizeof(int));
+    return mq_send(run->mq, msg, PTR_MSG_SIZE, prio);
+}
+
+static void *prioq_producer(void *arg)
+{
+    prioq_producer_arg *pa = (prioq_producer_arg *)arg;
+    prioq_run *run = pa->run;
+    unsigned rng = 0x9e3779b9u * (unsigned)(pa->idx + 1);
+    uint32_t seq = 0;
+
+    for (;;) {
+        uint64_t now = now_ns(CLOCK_MONOTONIC);
+        prioq_block *blk;
+
+        if (now >= run->deadline_ns)
+            break;
+        blk = buf_pool_get(run->pool);
+        if (blk == NULL) {
+            sched_yield();      /* the consumer holds every block */
+            continue;
+        }
+        memset(blk->payload, 'A' + pa->idx, sizeof(blk->payload));
+        blk->producer = (uint32_t)pa->idx;
+        blk->seq = seq++;
+        blk->sent_ns = now;
+        if (prioq_send(run, blk, pick_prio(run->mix, &rng)) == 0)
+            run->sent[pa->idx]++;
+        else
+            buf_pool_put(run->pool, blk);
+    }
+
+    /* Priority 0 and FIFO order: the consumer sees it after all of this producer's messages */
+    prioq_stop[pa->idx].seq = UINT32_MAX;
+    prioq_send(run, &prioq_stop[pa->idx], 0);
+    return NULL;
+}
+
+static void *prioq_consumer(void *arg)
+{
+    prioq_run *run = (prioq_run *)arg;
+    static uint32_t next_seq[MAX_THREADS][PRIO_QUEUE_LEVELS];
+    int stopped = 0;
+
+    memset(next_seq, 0, sizeof(next_seq));
+    while (stopped < run->producers) {
+        prioq_block *blk;
+        unsigned prio;
+        uint64_t lat;
+
+        if (run->use_prioq) {
+            blk = (prioq_block *)prio_queue_pop(run->pq, &prio);
+        } else {
+            char msg[PTR_MSG_SIZE];
+            if (mq_receive(run->mq, msg, PTR_MSG_SIZE, &prio) != (ssize_t)PTR_MSG_SIZE)
+                continue;
+            memcpy(&blk, msg, sizeof(void *));
+        }
+        if (blk->seq == UINT32_MAX) {
+            stopped++;
+            continue;
+        }
+
+        lat = now_ns(CLOCK_MONOTONIC) - blk->sent_ns;
+        hist_record(&run->lat, lat);
+        if (prio >= HIGH_PRIO)
+            hist_record(&run->high_lat, lat);
+        if (blk->seq < next_seq[blk->producer][prio])
+            run->order_errors++;
+        next_seq[blk->producer][prio] = blk->seq + 1;
+        run->received++;
+        buf_pool_put(run->pool, blk);
+    }
+    return NULL;
+}
+
+static int run_prioq(bool use_prioq, int producers, prio_mix mix, long depth, uint64_t duration_ns)
+{
+    struct mq_attr attr = { .mq_maxmsg = depth, .mq_msgsize = (long)PTR_MSG_SIZE };
+    static prioq_run run;
+    static prio_queue pq;
+    static prioq_producer_arg args[MAX_THREADS];
+    buf_pool pool;
+    pthread_t tids[MAX_THREADS], consumer_tid;
+    uint64_t start, elapsed;
+    double cpu;
+    long csw;
+    int rc;
+
+    memset(&run, 0, sizeof(run));
+    run.use_prioq = use_prioq;
+    run.producers = producers;
+    run.mix = mix;
+    run.pq = &pq;
+    run.pool = &pool;
+    hist_init(&run.lat);
+    hist_init(&run.high_lat);
+    prio_queue_init(&pq);
+
+    /* The same number of blocks in flight for both methods */
+    if ((rc = buf_pool_init(&pool, sizeof(prioq_block), (unsigned)depth + producers + 1)) != 0)
+        return rc;
+    if (!use_prioq) {
+        mq_unlink(BENCH_MQ);
+        run.mq = mq_open(BENCH_MQ, O_CREAT | O_RDWR, 0600, &attr);
+        if (run.mq == (mqd_t)-1) {
+            rc = errno;
+            buf_pool_destroy(&pool);
+            return rc;
+        }
+    }
+
+    cpu = cpu_seconds();
+    csw = context_switches();
+    start = now_ns(CLOCK_MONOTONIC);
+    run.deadline_ns = start + duration_ns;
+    pthread_create(&consumer_tid, NULL, prioq_consumer, &run);
+    for (int i = 0; i < producers; i++) {
+        args[i] = (prioq_producer_arg){ &run, i };
+        pthread_create(&tids[i], NULL, prioq_producer, &args[i]);
+    }
+    for (int i = 0; i < producers; i++)
+        pthread_join(tids[i], NULL);
+    pthread_join(consumer_tid, NULL);
+    elapsed = now_ns(CLOCK_MONOTONIC) - start;
+    cpu = cpu_seconds() - cpu;
+    csw = context_switches() - csw;
+
+    printf("%s,%d,%s,%lu,%.0f,%.3f,%.3f,", use_prioq ? "prio_queue" : "mqueue", producers,
+           mix_names[mix], (unsigned long)run.received, run.received / (elapsed / 1e9),
+           hist_percentile(&run.lat, 50.0) / 1e3, hist_percentile(&run.lat, 99.0) / 1e3);
+    if (hist_count(&run.high_lat))
+        printf("%.3f", hist_percentile(&run.high_lat, 99.0) / 1e3);
+    printf(",%.3f,%.1f,%.3f,%lu,%lu\n", atomic_load(&run.lat.max) / 1e3,
+           run.received ? cpu * 1e9 / run.received : 0.0,
+           run.received ? (double)csw / run.received : 0.0,
+           use_prioq ? (unsigned long)pq.sleeps : 0UL, (unsigned long)run.order_errors);
+    fflush(stdout);
+
+    if (!use_prioq) {
+        mq_close(run.mq);
+        mq_unlink(BENCH_MQ);
+    }
+    buf_pool_destroy(&pool);
+    return 0;
+}
+
+static void bench_prioq(int argc, char *argv[])
+{
+    long producers[MAX_LIST] = { 1, 4 };
+    int nproducers = 2;
+    long max_depth = read_limit("/proc/sys/fs/mqueue/msg_max", 10);
+    long depth = max_depth < 100 ? max_depth : 100;
+    uint64_t duration_ns = 500 * NSEC_PER_MSEC;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:p:q:")) != -1) {
+        switch (opt) {
+        case 'd': duration_ns = strtoull(optarg, NULL, 10) * NSEC_PER_MSEC; break;
+        case 'p': nproducers = parse_list(optarg, producers); break;
+        case 'q': depth = atol(optarg); break;
+        default: usage();
+        }
+    }
+    if (duration_ns == 0 || depth < 1)
+        usage();
+    if (depth > max_depth) {
+        /* The mqueue rows could not be opened; run both methods at the same depth */
+        fprintf(stderr, "depth %ld above msg_max, using %ld\n", depth, max_depth);
+        depth = max_depth;
+    }
+    for (int i = 0; i < nproducers; i++)
+        if (producers[i] < 1 || producers[i] > MAX_THREADS)
+            usage();
+
+    printf("method,producers,mix,msgs,msgs_per_sec,p50_us,p99_us,high_p99_us,max_us,"
+           "cpu_ns_per_msg,ctx_switches_per_msg,consumer_sleeps,order_errors\n");
+    for (int i = 0; i < nproducers; i++) {
+        for (prio_mix mix = MIX_SINGLE; mix <= MIX_BIMODAL; mix++) {
+            for (int use_prioq = 0; use_prioq <= 1; use_prioq++) {
+                int rc = run_prioq(use_prioq, (int)producers[i], mix, depth, duration_ns);
+                if (rc != 0)
+                    fprintf(stderr, "skip %s with %ld producers: %s\n",
+                            use_prioq ? "prio_queue" : "mqueue", producers[i], strerror(rc));
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+        usage();
+
+    optind = 2;
+    if (strcmp(argv[1], "sweep") == 0)
+        bench_sweep(argc, argv);
+    else if (strcmp(argv[1], "mux") == 0)
+        bench_mux(argc, argv);
+    else if (strcmp(argv[1], "frag") == 0)
+        bench_frag(argc, argv);
+    else if (strcmp(argv[1], "prioq") == 0)
+        bench_prioq(argc, argv);
+    else
+        usage();
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * File: mq_frag.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Message queue fragmentation and reassembly, see mq_frag.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "mq_frag.h"
+
+static size_t payload_size(size_t msgsize)
+{
+    return msgsize - sizeof(mq_frag_hdr);
+}
+
+static int queue_msgsize(mqd_t mq, size_t *msgsize)
+{
+    struct mq_attr attr;
+
+    if (mq_getattr(mq, &attr) != 0)
+        return errno;
+    if ((size_t)attr.mq_msgsize <= sizeof(mq_frag_hdr))
+        return EMSGSIZE;
+    *msgsize = (size_t)attr.mq_msgsize;
+    return 0;
+}
+
+int mq_frag_tx_init(mq_frag_tx *tx, mqd_t mq, uint32_t sender)
+{
+    int rc;
+
+    memset(tx, 0, sizeof(*tx));
+    rc = queue_msgsize(mq, &tx->msgsize);
+    if (rc != 0)
+        return rc;
+    tx->mq = mq;
+    tx->sender = sender;
+    tx->frame = malloc(tx->msgsize);
+    return tx->frame ? 0 : ENOMEM;
+}
+
+void mq_frag_tx_destroy(mq_frag_tx *tx)
+{
+    free(tx->frame);
+}
+
+int mq_frag_send(mq_frag_tx *tx, const void *data, size_t len, unsigned prio)
+{
+    size_t chunk = payload_size(tx->msgsize);
+    size_t count = len ? (len + chunk - 1) / chunk : 1;
+    mq_frag_hdr *hdr = (mq_frag_hdr *)tx->frame;
+
+    if (count > UINT16_MAX || len > UINT32_MAX) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    hdr->sender = tx->sender;
+    hdr->record = tx->next_record++;
+    hdr->count = (uint16_t)count;
+    hdr->length = (uint32_t)len;
+    for (size_t i = 0; i < count; i++) {
+        size_t off = i * chunk;
+        size_t n = len - off < chunk ? len - off : chunk;
+
+        hdr->index = (uint16_t)i;
+        memcpy(tx->frame + sizeof(mq_frag_hdr), (const char *)data + off, n);
+        if (mq_send(tx->mq, tx->frame, sizeof(mq_frag_hdr) + n, prio) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+int mq_frag_rx_init(mq_frag_rx *rx, mqd_t mq, size_t max_length, unsigned nslots)
+{
+    int rc;
+
+    memset(rx, 0, sizeof(*rx));
+    rc = queue_msgsize(mq, &rx->msgsize);
+    if (rc != 0)
+        return rc;
+    rx->mq = mq;
+    rx->max_length = max_length;
+    rx->nslots = nslots ? nslots : 1;
+    rx->frame = malloc(rx->msgsize);
+    rx->slots = calloc(rx->nslots, sizeof(mq_frag_slot));
+    if (rx->frame == NULL || rx->slots == NULL) {
+        mq_frag_rx_destroy(rx);
+        return ENOMEM;
+    }
+    for (unsigned i = 0; i < rx->nslots; i++) {
+        rx->slots[i].data = malloc(max_length ? max_length : 1);
+        if (rx->slots[i].data == NULL) {
+            mq_frag_rx_destroy(rx);
+            return ENOMEM;
+        }
+        /* Prefault so reassembly never takes a page fault */
+        memset(rx->slots[i].data, 0, max_length);
+        mlock(rx->slots[i].data, max_length);
+    }
+    return 0;
+}
+
+void mq_frag_rx_destroy(mq_frag_rx *rx)
+{
+    if (rx->slots != NULL) {
+        for (unsigned i = 0; i < rx->nslots; i++)
+            free(rx->slots[i].data);
+    }
+    free(rx->slots);
+    free(rx->frame);
+}
+
+/* Slot assembling (sender, record), or a free one (evicting the oldest incomplete record if needed) */
+static mq_frag_slot *find_slot(mq_frag_rx *rx, const mq_frag_hdr *hdr)
+{
+    mq_frag_slot *free_slot = NULL, *oldest = NULL;
+
+    for (unsigned i = 0; i < rx->nslots; i++) {
+        mq_frag_slot *s = &rx->slots[i];
+
+        if (s->state == FRAG_ASSEMBLING) {
+            if (s->sender == hdr->sender && s->record == hdr->record)
+                return s;
+            if (oldest == NULL || s->started < oldest->started)
+                oldest = s;
+        } else if (s->state == FRAG_FREE && free_slot == NULL) {
+            free_slot = s;
+        }
+    }
+    if (hdr->index != 0)
+        return NULL;        /* head of this record was lost */
+    if (free_slot == NULL && oldest != NULL) {
+        rx->evicted++;
+        rx->dropped++;
+        free_slot = oldest;
+    }
+    if (free_slot != NULL) {
+        free_slot->state = FRAG_ASSEMBLING;
+        free_slot->sender = hdr->sender;
+        free_slot->record = hdr->record;
+        free_slot->next_index = 0;
+        free_slot->count = hdr->count;
+        free_slot->length = hdr->length;
+        free_slot->received = 0;
+        free_slot->started = rx->calls;
+    }
+    return free_slot;
+}
+
+ssize_t mq_frag_receive(mq_frag_rx *rx, void **data, unsigned *prio)
+{
+    size_t chunk = payload_size(rx->msgsize);
+    const mq_frag_hdr *hdr = (const mq_frag_hdr *)rx->frame;
+
+    for (;;) {
+        unsigned p;
+        ssize_t n = mq_receive(rx->mq, rx->frame, rx->msgsize, &p);
+        mq_frag_slot *s;
+        size_t off;
+
+        if (n < 0)
+            return -1;
+        rx->calls++;
+        if ((size_t)n < sizeof(mq_frag_hdr)) {
+            rx->dropped++;              /* no header to tell which record it belonged to */
+            continue;
+        }
+        if (hdr->length > rx->max_length) {
+            rx->dropped += hdr->index == 0;
+            continue;
+        }
+
+        s = find_slot(rx, hdr);
+        if (s == NULL) {
+            rx->dropped += hdr->index == 0;
+            continue;
+        }
+        off = (size_t)hdr->index * chunk;
+        if (hdr->index != s->next_index || hdr->count != s->count ||
+            off + (size_t)n - sizeof(mq_frag_hdr) > s->length) {
+            s->state = FRAG_FREE;       /* gap or corrupt fragment: drop the record */
+            rx->dropped++;
+            continue;
+        }
+
+        memcpy(s->data + off, rx->frame + sizeof(mq_frag_hdr), (size_t)n - sizeof(mq_frag_hdr));
+        s->received += (uint32_t)((size_t)n - sizeof(mq_frag_hdr));
+        s->prio = p;
+        if (++s->next_index == s->count) {
+            if (s->received != s->length) {
+                s->state = FRAG_FREE;   /* count disagrees with length: part of the buffer is stale */
+                rx->dropped++;
+                continue;
+            }
+            s->state = FRAG_DELIVERED;
+            rx->completed++;
+            *data = s->data;
+            if (prio != NULL)
+                *prio = s->prio;
+            return (ssize_t)s->length;
+        }
+    }
+}
+
+void mq_frag_release(mq_frag_rx *rx, void *data)
+{
+    for (unsigned i = 0; i < rx->nslots; i++) {
+        if (rx->slots[i].data == data) {
+            rx->slots[i].state = FRAG_FREE;
+            return;
+        }
+    }
+}
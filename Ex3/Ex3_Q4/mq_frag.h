@@ -0,0 +1,99 @@
+/*
+ * File: mq_frag.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Fragmentation and reassembly of large records over a POSIX
+ *		message queue.
+ *
+ *		mq_frag_send() splits a record into fragments that fit the
+ *		queue's mq_msgsize. Each fragment carries a header with the
+ *		sender id, a per-sender record id, its index, the fragment
+ *		count and the record length. All fragments of a record go out
+ *		at the record's priority, so the queue keeps them in order and a
+ *		higher-priority record can overtake a lower one mid-stream.
+ *
+ *		The receiver copies fragments straight into one of 'nslots'
+ *		preallocated reassembly buffers and returns a pointer to the
+ *		whole record once its last fragment arrives, so records are
+ *		delivered in completion order and priority order is kept. The
+ *		caller hands the buffer back with mq_frag_release(). A record
+ *		with a missing or out-of-order fragment is dropped. When every
+ *		slot is busy, the oldest incomplete record is evicted to make
+ *		room.
+ * Date: 16th October 2026
+ */
+
+#ifndef MQ_FRAG_H
+#define MQ_FRAG_H
+
+#include <mqueue.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef struct {
+    uint32_t sender;
+    uint32_t record;
+    uint16_t index;
+    uint16_t count;
+    uint32_t length;        /* whole record */
+} mq_frag_hdr;
+
+typedef struct {
+    mqd_t mq;
+    size_t msgsize;
+    uint32_t sender;
+    uint32_t next_record;
+    char *frame;
+} mq_frag_tx;
+
+typedef enum { FRAG_FREE, FRAG_ASSEMBLING, FRAG_DELIVERED } mq_frag_state;
+
+typedef struct {
+    mq_frag_state state;
+    uint32_t sender;
+    uint32_t record;
+    uint16_t next_index;
+    uint16_t count;
+    uint32_t length;
+    uint32_t received;      /* payload bytes copied so far */
+    unsigned prio;
+    uint64_t started;       /* receive call count when the first fragment arrived */
+    char *data;
+} mq_frag_slot;
+
+typedef struct {
+    mqd_t mq;
+    size_t msgsize;
+    size_t max_length;
+    unsigned nslots;
+    mq_frag_slot *slots;
+    char *frame;
+    uint64_t calls;
+
+    uint64_t completed;
+    uint64_t dropped;       /* gaps, short frames, bad lengths, oversize records and evictions */
+    uint64_t evicted;
+} mq_frag_rx;
+
+/* Returns 0 or an errno value. The queue's mq_msgsize must exceed the header size. */
+int mq_frag_tx_init(mq_frag_tx *tx, mqd_t mq, uint32_t sender);
+void mq_frag_tx_destroy(mq_frag_tx *tx);
+
+/* Send one record. Returns 0, or -1 with errno from mq_send (or EMSGSIZE). */
+int mq_frag_send(mq_frag_tx *tx, const void *data, size_t len, unsigned prio);
+
+/* Returns 0 or an errno value */
+int mq_frag_rx_init(mq_frag_rx *rx, mqd_t mq, size_t max_length, unsigned nslots);
+void mq_frag_rx_destroy(mq_frag_rx *rx);
+
+/*
+ * Receive until a record is complete. Returns its length and points *data at
+ * the reassembly buffer, or -1 with errno from mq_receive (e.g. EAGAIN on a
+ * non-blocking queue).
+ */
+ssize_t mq_frag_receive(mq_frag_rx *rx, void **data, unsigned *prio);
+
+/* Return a buffer obtained from mq_frag_receive() */
+void mq_frag_release(mq_frag_rx *rx, void *data);
+
+#endif /* MQ_FRAG_H */
@@ -0,0 +1,184 @@
+/*
+ * File: mq_mux.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: epoll based message queue multiplexer, see mq_mux.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "mq_mux.h"
+
+#define MUX_EVENTS 64
+#define MUX_STOP_TAG UINT32_MAX
+
+int mq_mux_init(mq_mux *mux, unsigned batch)
+{
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = MUX_STOP_TAG };
+
+    memset(mux, 0, sizeof(*mux));
+    mux->stop_fd = -1;
+    mux->batch = batch ? batch : 1;
+    mux->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (mux->epfd < 0)
+        return errno;
+    /* One round drains at most 'batch' messages from each of MUX_EVENTS queues */
+    mux->pending_cap = (size_t)MUX_EVENTS * mux->batch;
+    mux->pending = malloc(mux->pending_cap * sizeof(mq_mux_msg));
+    mux->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (mux->pending == NULL || mux->stop_fd < 0 || epoll_ctl(mux->epfd, EPOLL_CTL_ADD, mux->stop_fd, &ev) != 0) {
+        int err = errno;
+        if (mux->stop_fd >= 0)
+            close(mux->stop_fd);
+        free(mux->pending);
+        close(mux->epfd);
+        /* Leave nothing for a later mq_mux_destroy() to free or close again */
+        mux->pending = NULL;
+        mux->stop_fd = mux->epfd = -1;
+        return err ? err : ENOMEM;
+    }
+    return 0;
+}
+
+void mq_mux_destroy(mq_mux *mux)
+{
+    for (int i = 0; i < mux->nqueues; i++)
+        free(mux->queues[i].buf);
+    free(mux->queues);
+    free(mux->pending);
+    if (mux->stop_fd >= 0)
+        close(mux->stop_fd);
+    if (mux->epfd >= 0)
+        close(mux->epfd);
+}
+
+int mq_mux_add(mq_mux *mux, mqd_t mq, mq_mux_handler handler, void *ctx)
+{
+    struct mq_attr attr, nonblock;
+    struct epoll_event ev = { .events = EPOLLIN };
+    mq_mux_queue *q;
+
+    if (mq_getattr(mq, &attr) != 0)
+        return -1;
+
+    if (mux->nqueues == mux->capacity) {
+        int cap = mux->capacity ? 2 * mux->capacity : 16;
+        mq_mux_queue *grown = realloc(mux->queues, cap * sizeof(*grown));
+        if (grown == NULL)
+            return -1;
+        mux->queues = grown;
+        mux->capacity = cap;
+    }
+
+    q = &mux->queues[mux->nqueues];
+    q->mq = mq;
+    q->handler = handler;
+    q->ctx = ctx;
+    q->msgsize = (size_t)attr.mq_msgsize;
+    q->buf = malloc(q->msgsize * mux->batch);
+    if (q->buf == NULL)
+        return -1;
+
+    /* Only this open description becomes non-blocking, not other openers of the queue */
+    nonblock = attr;
+    nonblock.mq_flags = O_NONBLOCK;
+    ev.data.u32 = (uint32_t)mux->nqueues;
+    if (mq_setattr(mq, &nonblock, NULL) != 0 ||
+        epoll_ctl(mux->epfd, EPOLL_CTL_ADD, (int)mq, &ev) != 0) {
+        free(q->buf);
+        return -1;
+    }
+    return mux->nqueues++;
+}
+
+/* Higher priority first, then drain order */
+static int by_prio(const void *a, const void *b)
+{
+    const mq_mux_msg *ma = a, *mb = b;
+
+    if (ma->prio != mb->prio)
+        return ma->prio > mb->prio ? -1 : 1;
+    return ma->seq < mb->seq ? -1 : ma->seq > mb->seq;
+}
+
+int mq_mux_poll(mq_mux *mux, int timeout_ms)
+{
+    struct epoll_event events[MUX_EVENTS];
+    int ready[MUX_EVENTS];      /* queues that may still hold messages */
+    int n, nready = 0, active, first;
+
+    n = epoll_wait(mux->epfd, events, MUX_EVENTS, timeout_ms);
+    if (n < 0)
+        return errno == EINTR ? 0 : -1;
+    mux->wakeups++;
+    mux->npending = 0;
+
+    for (int e = 0; e < n; e++) {
+        if (events[e].data.u32 == MUX_STOP_TAG) {
+            uint64_t count;
+
+            /* Clear it, or every later poll would return at once */
+            if (read(mux->stop_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+                return -1;
+            continue;
+        }
+        ready[nready++] = (int)events[e].data.u32;
+    }
+
+    /* One message from each queue per pass, so no queue's backlog goes ahead of the others' heads */
+    first = nready ? (int)(mux->wakeups % (uint64_t)nready) : 0;
+    active = nready;
+    for (unsigned slot = 0; slot < mux->batch && active > 0; slot++) {
+        for (int i = 0; i < nready; i++) {
+            int idx = ready[(first + i) % nready];
+            mq_mux_queue *q;
+            unsigned prio;
+            ssize_t len;
+
+            if (idx < 0)
+                continue;
+            q = &mux->queues[idx];
+            len = mq_receive(q->mq, q->buf + slot * q->msgsize, q->msgsize, &prio);
+            if (len < 0) {
+                ready[(first + i) % nready] = -1;      /* EAGAIN: drained */
+                active--;
+                continue;
+            }
+            mux->pending[mux->npending] = (mq_mux_msg){ idx, slot, prio, (unsigned)mux->npending, (size_t)len };
+            mux->npending++;
+        }
+    }
+
+    if (mux->npending > 1)
+        qsort(mux->pending, mux->npending, sizeof(mq_mux_msg), by_prio);
+    for (size_t i = 0; i < mux->npending; i++) {
+        mq_mux_msg *m = &mux->pending[i];
+        mq_mux_queue *q = &mux->queues[m->queue];
+        q->handler(q->ctx, m->queue, q->buf + m->slot * q->msgsize, m->len, m->prio);
+    }
+    mux->messages += mux->npending;
+    return (int)mux->npending;
+}
+
+int mq_mux_run(mq_mux *mux)
+{
+    while (!atomic_load_explicit(&mux->stop, memory_order_acquire)) {
+        if (mq_mux_poll(mux, -1) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+void mq_mux_stop(mq_mux *mux)
+{
+    uint64_t one = 1;
+
+    atomic_store_explicit(&mux->stop, true, memory_order_release);
+    if (write(mux->stop_fd, &one, sizeof(one)) < 0)
+        return;     /* counter saturated: a wakeup is already pending */
+}
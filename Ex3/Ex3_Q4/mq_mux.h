@@ -0,0 +1,82 @@
+/*
+ * File: mq_mux.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Single-threaded receiver for many POSIX message queues.
+ *
+ *		On Linux an mqd_t is a file descriptor, so the queues are
+ *		registered with one epoll instance and made non-blocking.
+ *		Each wakeup drains up to 'batch' messages from every ready
+ *		queue, taking one message from each in turn and starting with
+ *		a different queue every round, then dispatches everything
+ *		drained in that round highest priority first, each to the
+ *		handler registered for its queue. Within a priority messages
+ *		keep the order they were drained in: FIFO for each queue, and
+ *		interleaved across queues, whose relative arrival order the
+ *		kernel does not tell. Level-triggered epoll brings a queue
+ *		that still holds messages back next round, so one busy queue
+ *		cannot starve the others.
+ *
+ *		mq_mux_run() loops until mq_mux_stop() is called, which is
+ *		safe from any thread.
+ * Date: 16th October 2026
+ */
+
+#ifndef MQ_MUX_H
+#define MQ_MUX_H
+
+#include <mqueue.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef void (*mq_mux_handler)(void *ctx, int queue, const char *msg, size_t len, unsigned prio);
+
+typedef struct {
+    mqd_t mq;
+    mq_mux_handler handler;
+    void *ctx;
+    size_t msgsize;
+    char *buf;              /* 'batch' slots of msgsize bytes */
+} mq_mux_queue;
+
+typedef struct {
+    int queue;
+    unsigned slot;
+    unsigned prio;
+    unsigned seq;           /* drain order within the round */
+    size_t len;
+} mq_mux_msg;
+
+typedef struct {
+    int epfd;
+    int stop_fd;            /* eventfd that wakes epoll_wait for mq_mux_stop() */
+    atomic_bool stop;
+    unsigned batch;
+
+    int nqueues, capacity;
+    mq_mux_queue *queues;
+    mq_mux_msg *pending;    /* messages drained in the current round */
+    size_t npending, pending_cap;
+
+    uint64_t wakeups;
+    uint64_t messages;
+} mq_mux;
+
+/* Returns 0 or an errno value. mq_mux_destroy() is safe after a failed init. */
+int mq_mux_init(mq_mux *mux, unsigned batch);
+
+void mq_mux_destroy(mq_mux *mux);
+
+/* Register a queue and switch it to non-blocking. Returns its index, or -1 with errno set. */
+int mq_mux_add(mq_mux *mux, mqd_t mq, mq_mux_handler handler, void *ctx);
+
+/* Wait up to timeout_ms (-1: forever) and dispatch one round. Returns the messages dispatched or -1. */
+int mq_mux_poll(mq_mux *mux, int timeout_ms);
+
+/* Dispatch until mq_mux_stop() */
+int mq_mux_run(mq_mux *mux);
+
+void mq_mux_stop(mq_mux *mux);
+
+#endif /* MQ_MUX_H */
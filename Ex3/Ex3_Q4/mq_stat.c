@@ -0,0 +1,95 @@
+/*
+ * File: mq_stat.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Prints the queue telemetry published by heap_mq, heap_shmq,
+ *		posix_mq or posix_shmq (see mq_telemetry.h). Attaches
+ *		read-only to the snapshot segment and prints one table per
+ *		interval: depth, sampled high-water depth and capacity, send
+ *		and receive rates, totals, drops, errors and the
+ *		enqueue-to-dequeue latency percentiles. Runs until "-c"
+ *		tables have been printed or the publishing process exits.
+ *		A snapshot left mid-update is reported instead of printed.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mq_telemetry.h"
+#include "rt_time.h"
+
+static void usage(void)
+{
+    printf("Usage: mq_stat [-n shm_name] [-i interval_ms] [-c count]\n");
+    exit(1);
+}
+
+static void print_snapshot(const mq_telemetry_snapshot *snap)
+{
+    printf("%-20s %6s %6s %6s %10s %10s %10s %10s %8s %8s %10s %10s %10s\n",
+           "queue", "depth", "high", "max", "sent/s", "recv/s", "sent", "received",
+           "dropped", "errors", "p50_us", "p99_us", "max_us");
+    for (unsigned i = 0; i < snap->nqueues && i < MQ_TELEMETRY_MAX_QUEUES; i++) {
+        const mq_telemetry_stats *st = &snap->queues[i];
+
+        printf("%-20.*s %6ld %6ld %6ld %10.0f %10.0f %10lu %10lu %8lu %8lu %10.3f %10.3f %10.3f\n",
+               MQ_TELEMETRY_NAME_LEN, st->name, st->depth, st->depth_high, st->maxmsg,
+               st->send_rate, st->recv_rate, (unsigned long)st->sent, (unsigned long)st->received,
+               (unsigned long)st->dropped, (unsigned long)(st->send_errors + st->recv_errors),
+               st->latency_p50 / 1e3, st->latency_p99 / 1e3, st->latency_max / 1e3);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = MQ_TELEMETRY_SHM;
+    uint64_t interval_ns = 1000 * NSEC_PER_MSEC;
+    unsigned long count = 0;
+    const mq_telemetry_shm *shm;
+    static mq_telemetry_snapshot snap;
+    struct timespec interval;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:i:c:")) != -1) {
+        switch (opt) {
+        case 'n': name = optarg; break;
+        case 'i': interval_ns = strtoull(optarg, NULL, 10) * NSEC_PER_MSEC; break;
+        case 'c': count = strtoul(optarg, NULL, 10); break;
+        default: usage();
+        }
+    }
+    if (interval_ns == 0)
+        usage();
+    interval = ns_to_ts(interval_ns);
+
+    shm = mq_telemetry_attach(name);
+    if (shm == NULL) {
+        fprintf(stderr, "mq_stat: cannot attach to %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    printf("mq_stat: %s, published by pid %d\n", name, (int)shm->writer_pid);
+
+    for (unsigned long n = 0; count == 0 || n < count; n++) {
+        if (n > 0)
+            nanosleep(&interval, NULL);
+        if (mq_telemetry_read(shm, &snap) < 0) {
+            fprintf(stderr, "mq_stat: snapshot of pid %d stuck mid-update\n", (int)shm->writer_pid);
+        } else {
+            printf("\nsample at %.3f s, period %.0f ms\n", snap.sample_ns / 1e9, snap.period_ns / 1e6);
+            print_snapshot(&snap);
+        }
+
+        // The mapping outlives the publisher; stop once it has gone
+        if (kill(shm->writer_pid, 0) != 0 && errno == ESRCH)
+            break;
+    }
+
+    mq_telemetry_detach(shm);
+    return 0;
+}
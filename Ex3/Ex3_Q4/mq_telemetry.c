@@ -0,0 +1,228 @@
+/*
+ * File: mq_telemetry.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Per-queue telemetry and its shared memory snapshot, see
+ *		mq_telemetry.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mq_telemetry.h"
+#include "periodic.h"
+#include "rt_time.h"
+
+static mq_telemetry_queue queues[MQ_TELEMETRY_MAX_QUEUES];
+static atomic_uint nqueues;
+
+static mq_telemetry_shm *shm;
+static char shm_name[64];
+static pthread_t sampler_thread;
+static atomic_bool stopping;
+static periodic_task sampler_task;
+
+/* Previous counters, for the rates */
+static uint64_t last_sent[MQ_TELEMETRY_MAX_QUEUES], last_received[MQ_TELEMETRY_MAX_QUEUES];
+static uint64_t last_sample_ns;
+
+mq_telemetry_queue *mq_telemetry_register(const char *name, mqd_t mq)
+{
+    unsigned idx = atomic_load(&nqueues);
+    mq_telemetry_queue *q;
+
+    if (idx >= MQ_TELEMETRY_MAX_QUEUES)
+        return NULL;
+    q = &queues[idx];
+    memset(q, 0, sizeof(*q));
+    strncpy(q->name, name, sizeof(q->name) - 1);
+    q->mq = mq;
+    hist_init(&q->latency);
+    atomic_store_explicit(&nqueues, idx + 1, memory_order_release);   /* visible to the sampler */
+    return q;
+}
+
+static void sample(void)
+{
+    unsigned n = atomic_load_explicit(&nqueues, memory_order_acquire);
+    mq_telemetry_snapshot *snap = &shm->snap;
+    uint64_t now = now_ns(CLOCK_MONOTONIC);
+    double dt = last_sample_ns ? (double)(now - last_sample_ns) / NSEC_PER_SEC : 0.0;
+    unsigned seq = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&shm->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    snap->sample_ns = now;
+    snap->period_ns = sampler_task.period_ns;
+    snap->nqueues = n;
+    for (unsigned i = 0; i < n; i++) {
+        mq_telemetry_queue *q = &queues[i];
+        mq_telemetry_stats *st = &snap->queues[i];
+        struct mq_attr attr;
+
+        memcpy(st->name, q->name, sizeof(st->name));
+        if (mq_getattr(q->mq, &attr) == 0) {
+            st->depth = attr.mq_curmsgs;
+            st->maxmsg = attr.mq_maxmsg;
+        } else {
+            st->depth = -1;
+            st->maxmsg = -1;
+        }
+        if (st->depth > q->depth_high)
+            q->depth_high = st->depth;
+        st->depth_high = q->depth_high;
+
+        st->sent = atomic_load_explicit(&q->sent, memory_order_relaxed);
+        st->received = atomic_load_explicit(&q->received, memory_order_relaxed);
+        st->send_errors = atomic_load_explicit(&q->send_errors, memory_order_relaxed);
+        st->recv_errors = atomic_load_explicit(&q->recv_errors, memory_order_relaxed);
+        st->dropped = atomic_load_explicit(&q->dropped, memory_order_relaxed);
+        st->send_rate = dt > 0.0 ? (double)(st->sent - last_sent[i]) / dt : 0.0;
+        st->recv_rate = dt > 0.0 ? (double)(st->received - last_received[i]) / dt : 0.0;
+        last_sent[i] = st->sent;
+        last_received[i] = st->received;
+
+        st->latency_count = hist_count(&q->latency);
+        st->latency_mean = hist_mean(&q->latency);
+        st->latency_p50 = hist_percentile(&q->latency, 50.0);
+        st->latency_p99 = hist_percentile(&q->latency, 99.0);
+        st->latency_p999 = hist_percentile(&q->latency, 99.9);
+        st->latency_max = atomic_load_explicit(&q->latency.max, memory_order_relaxed);
+    }
+    last_sample_ns = now;
+
+    atomic_store_explicit(&shm->seq, seq + 2, memory_order_release);
+}
+
+static void *sampler(void *arg)
+{
+    struct sched_param param = { .sched_priority = 0 };
+
+    (void)arg;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+
+    while (!atomic_load(&stopping)) {
+        sample();
+        periodic_wait(&sampler_task);
+    }
+    return NULL;
+}
+
+int mq_telemetry_start(const char *name, uint64_t period_ns)
+{
+    pthread_attr_t attr;
+    struct sched_param param = { .sched_priority = 0 };
+    int fd, rc;
+
+    if (shm != NULL)
+        return EBUSY;
+
+    fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return errno;
+    if (ftruncate(fd, sizeof(mq_telemetry_shm)) != 0) {
+        rc = errno;
+        close(fd);
+        return rc;
+    }
+    shm = mmap(NULL, sizeof(mq_telemetry_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        shm = NULL;
+        return errno;
+    }
+    strncpy(shm_name, name, sizeof(shm_name) - 1);
+
+    /* Invalidate first so readers wait while the segment is rebuilt */
+    atomic_store_explicit(&shm->magic, 0, memory_order_relaxed);
+    shm->layout = MQ_TELEMETRY_LAYOUT;
+    shm->size = sizeof(mq_telemetry_shm);
+    shm->writer_pid = getpid();
+    atomic_store_explicit(&shm->seq, 0, memory_order_relaxed);
+    periodic_init(&sampler_task, period_ns);
+    last_sample_ns = 0;
+    sample();
+    atomic_store_explicit(&shm->magic, MQ_TELEMETRY_MAGIC, memory_order_release);
+
+    /* Never inherit the SCHED_FIFO policy of a real-time caller */
+    atomic_store(&stopping, false);
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+    rc = pthread_create(&sampler_thread, &attr, sampler, NULL);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        munmap(shm, sizeof(mq_telemetry_shm));
+        shm_unlink(shm_name);
+        shm = NULL;
+    }
+    return rc;
+}
+
+void mq_telemetry_stop(void)
+{
+    if (shm == NULL)
+        return;
+
+    atomic_store(&stopping, true);
+    pthread_join(sampler_thread, NULL);
+    sample();           /* readers still attached see the final counters */
+
+    munmap(shm, sizeof(mq_telemetry_shm));
+    shm_unlink(shm_name);
+    shm = NULL;
+}
+
+void mq_telemetry_report(FILE *out, const mq_telemetry_queue *q)
+{
+    char label[MQ_TELEMETRY_NAME_LEN + 16];
+
+    fprintf(out, "%s: %lu sent, %lu received, %lu dropped, %lu send errors, %lu receive errors, "
+            "high-water depth %ld\n", q->name,
+            (unsigned long)atomic_load(&q->sent), (unsigned long)atomic_load(&q->received),
+            (unsigned long)atomic_load(&q->dropped), (unsigned long)atomic_load(&q->send_errors),
+            (unsigned long)atomic_load(&q->recv_errors), q->depth_high);
+    snprintf(label, sizeof(label), "%s latency", q->name);
+    hist_print(out, label, &q->latency);
+}
+
+const mq_telemetry_shm *mq_telemetry_attach(const char *name)
+{
+    const mq_telemetry_shm *seg;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mq_telemetry_shm)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    seg = mmap(NULL, sizeof(mq_telemetry_shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED)
+        return NULL;
+
+    if (atomic_load_explicit((atomic_uint *)&seg->magic, memory_order_acquire) != MQ_TELEMETRY_MAGIC ||
+        seg->layout != MQ_TELEMETRY_LAYOUT || seg->size != sizeof(mq_telemetry_shm)) {
+        munmap((void *)seg, sizeof(mq_telemetry_shm));
+        errno = EPROTO;
+        return NULL;
+    }
+    return seg;
+}
+
+void mq_telemetry_detach(const mq_telemetry_shm *seg)
+{
+    munmap((void *)seg, sizeof(mq_telemetry_shm));
+}
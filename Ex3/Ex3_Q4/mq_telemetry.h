@@ -0,0 +1,157 @@
+/*
+ * File: mq_telemetry.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Per-queue telemetry for the Q4 message queues.
+ *
+ *		A program registers each queue it uses and counts sends,
+ *		receives, errors and drops with the inline calls below: one
+ *		relaxed atomic add each, no system call. The receiver also
+ *		records the enqueue-to-dequeue latency of every message in a
+ *		histogram, so there must be one receiving thread per queue.
+ *
+ *		A SCHED_OTHER sampler thread wakes every period, reads the
+ *		current depth of every queue with mq_getattr(), derives the
+ *		send and receive rates over the period and publishes a
+ *		snapshot of all queues into a POSIX shared memory segment
+ *		behind a sequence counter. External readers (mq_stat) map the
+ *		segment read-only and copy snapshots without disturbing the
+ *		queue users; a copy that keeps finding an update in progress
+ *		gives up after MQ_TELEMETRY_READ_RETRIES retries, so a
+ *		publisher killed mid-update cannot hang the reader. The
+ *		high-water depth is the largest sampled
+ *		depth, so bursts shorter than the period can be missed.
+ * Date: 16th October 2026
+ */
+
+#ifndef MQ_TELEMETRY_H
+#define MQ_TELEMETRY_H
+
+#include <mqueue.h>
+#ifdef SHMQ_REPLACE_MQ
+#include "shmq.h"
+#endif
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "hist.h"
+
+#define MQ_TELEMETRY_SHM        "/rtes_mq_telemetry"
+#define MQ_TELEMETRY_MAGIC      0x4d515453u     /* "MQTS" */
+#define MQ_TELEMETRY_LAYOUT     1
+#define MQ_TELEMETRY_MAX_QUEUES 8
+#define MQ_TELEMETRY_NAME_LEN   32
+#define MQ_TELEMETRY_READ_RETRIES 65536  /* each retry yields the CPU once */
+
+/* Live counters of one queue, private to the process */
+typedef struct {
+    char name[MQ_TELEMETRY_NAME_LEN];
+    mqd_t mq;
+    _Alignas(64) _Atomic uint64_t sent;     /* sender side */
+    _Atomic uint64_t send_errors;
+    _Atomic uint64_t dropped;
+    _Alignas(64) _Atomic uint64_t received; /* receiver side */
+    _Atomic uint64_t recv_errors;
+    hist_t latency;
+    long depth_high;                        /* sampler only */
+} mq_telemetry_queue;
+
+/* One queue in a published snapshot */
+typedef struct {
+    char name[MQ_TELEMETRY_NAME_LEN];
+    long depth, depth_high, maxmsg;
+    uint64_t sent, received, send_errors, recv_errors, dropped;
+    double send_rate, recv_rate;            /* messages/s over the last period */
+    uint64_t latency_count;                 /* latencies in ns */
+    uint64_t latency_p50, latency_p99, latency_p999, latency_max;
+    double latency_mean;
+} mq_telemetry_stats;
+
+typedef struct {
+    uint64_t sample_ns;                     /* CLOCK_MONOTONIC time of the snapshot */
+    uint64_t period_ns;
+    uint32_t nqueues;
+    mq_telemetry_stats queues[MQ_TELEMETRY_MAX_QUEUES];
+} mq_telemetry_snapshot;
+
+/* The shared segment; the magic number is stored last, as in nav_shm */
+typedef struct {
+    atomic_uint magic;
+    uint32_t layout;                        /* MQ_TELEMETRY_LAYOUT */
+    uint32_t size;                          /* sizeof(mq_telemetry_shm) */
+    pid_t writer_pid;
+    _Alignas(64) atomic_uint seq;           /* odd while a snapshot is written */
+    mq_telemetry_snapshot snap;
+} mq_telemetry_shm;
+
+/* Add a queue to the telemetry. Returns NULL when MQ_TELEMETRY_MAX_QUEUES are registered. */
+mq_telemetry_queue *mq_telemetry_register(const char *name, mqd_t mq);
+
+/* Create the segment 'shm_name' and start sampling. Returns 0 or an errno value. */
+int mq_telemetry_start(const char *shm_name, uint64_t period_ns);
+
+/* Take a last sample, stop the sampler and unlink the segment */
+void mq_telemetry_stop(void);
+
+/* Counters and latency histogram of one queue */
+void mq_telemetry_report(FILE *out, const mq_telemetry_queue *q);
+
+static inline void mq_telemetry_sent(mq_telemetry_queue *q, uint64_t n)
+{
+    atomic_fetch_add_explicit(&q->sent, n, memory_order_relaxed);
+}
+
+static inline void mq_telemetry_dropped(mq_telemetry_queue *q, uint64_t n)
+{
+    atomic_fetch_add_explicit(&q->dropped, n, memory_order_relaxed);
+}
+
+static inline void mq_telemetry_send_error(mq_telemetry_queue *q)
+{
+    atomic_fetch_add_explicit(&q->send_errors, 1, memory_order_relaxed);
+}
+
+/* Receiver only: one message dequeued 'latency_ns' after it was enqueued */
+static inline void mq_telemetry_received(mq_telemetry_queue *q, uint64_t latency_ns)
+{
+    hist_record(&q->latency, latency_ns);
+    atomic_fetch_add_explicit(&q->received, 1, memory_order_relaxed);
+}
+
+static inline void mq_telemetry_recv_error(mq_telemetry_queue *q)
+{
+    atomic_fetch_add_explicit(&q->recv_errors, 1, memory_order_relaxed);
+}
+
+/* Map an existing segment read-only. Returns NULL and sets errno on failure. */
+const mq_telemetry_shm *mq_telemetry_attach(const char *shm_name);
+
+void mq_telemetry_detach(const mq_telemetry_shm *shm);
+
+/*
+ * Copy a consistent snapshot out of a (possibly read-only) segment. Returns
+ * the retry count, or -1 if the segment stayed mid-update for too long.
+ */
+static inline int mq_telemetry_read(const mq_telemetry_shm *shm, mq_telemetry_snapshot *dst)
+{
+    atomic_uint *seq = (atomic_uint *)&shm->seq;
+    unsigned retries, start;
+
+    for (retries = 0; retries <= MQ_TELEMETRY_READ_RETRIES; retries++) {
+        start = atomic_load_explicit(seq, memory_order_acquire);
+        if (start & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy(dst, &shm->snap, sizeof(*dst));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(seq, memory_order_relaxed) == start)
+            return (int)retries;
+    }
+    return -1;
+}
+
+#endif /* MQ_TELEMETRY_H */
@@ -0,0 +1,216 @@
+/*
+ * File: mq_tx.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Non-blocking message queue sender, see mq_tx.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mq_tx.h"
+
+static const char *policy_names[] = { "drop-newest", "drop-oldest", "coalesce" };
+
+static void raise_backpressure(mq_tx *tx)
+{
+    if (!atomic_load_explicit(&tx->backpressure, memory_order_relaxed)) {
+        atomic_store_explicit(&tx->backpressure, true, memory_order_relaxed);
+        tx->backpressure_events++;
+    }
+}
+
+int mq_tx_init(mq_tx *tx, mqd_t mq, mq_tx_policy policy, mq_tx_discard discard, void *ctx)
+{
+    struct mq_attr attr;
+
+    memset(tx, 0, sizeof(*tx));
+    if (mq_getattr(mq, &attr) != 0)
+        return errno;
+    if (!(attr.mq_flags & O_NONBLOCK))
+        return EINVAL;
+#ifdef SHMQ_REPLACE_MQ
+    /* shmq allows a single receiver, so the sender cannot take messages back out */
+    if (policy == MQ_TX_DROP_OLDEST)
+        return EINVAL;
+#endif
+
+    tx->mq = mq;
+    tx->maxmsg = attr.mq_maxmsg;
+    tx->msgsize = (size_t)attr.mq_msgsize;
+    tx->policy = policy;
+    tx->discard = discard;
+    tx->ctx = ctx;
+    tx->high_mark = (attr.mq_maxmsg * 3 + 3) / 4;
+    tx->low_mark = attr.mq_maxmsg / 4;
+    tx->parked = malloc(tx->msgsize);
+    tx->scratch = malloc(tx->msgsize);
+    if (tx->parked == NULL || tx->scratch == NULL) {
+        mq_tx_destroy(tx);
+        return ENOMEM;
+    }
+    return 0;
+}
+
+void mq_tx_destroy(mq_tx *tx)
+{
+    if (tx->has_parked) {
+        if (tx->discard)
+            tx->discard(tx->ctx, tx->parked, tx->parked_len);
+        tx->dropped_newest++;
+    }
+    tx->has_parked = false;
+    free(tx->parked);
+    free(tx->scratch);
+}
+
+static void discard(mq_tx *tx, const char *msg, size_t len)
+{
+    if (tx->discard)
+        tx->discard(tx->ctx, msg, len);
+}
+
+/* Try to queue one message. Returns 0, EAGAIN when full, or another errno value. */
+static int try_send(mq_tx *tx, const char *msg, size_t len, unsigned prio)
+{
+    if (mq_send(tx->mq, msg, len, prio) == 0) {
+        tx->sent++;
+        return 0;
+    }
+    return errno;
+}
+
+int mq_tx_send(mq_tx *tx, const char *msg, size_t len, unsigned prio)
+{
+    int rc;
+
+    if (len > tx->msgsize) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    /* A parked message is older than this one, so it goes first */
+    if (tx->has_parked) {
+        rc = try_send(tx, tx->parked, tx->parked_len, tx->parked_prio);
+        if (rc == 0) {
+            tx->has_parked = false;
+        } else if (rc == EAGAIN) {
+            discard(tx, tx->parked, tx->parked_len);
+            tx->coalesced++;
+            memcpy(tx->parked, msg, len);
+            tx->parked_len = len;
+            tx->parked_prio = prio;
+            return MQ_TX_PARKED;
+        } else {
+            errno = rc;
+            return -1;
+        }
+    }
+
+    rc = try_send(tx, msg, len, prio);
+    if (rc == 0)
+        return MQ_TX_SENT;
+    if (rc != EAGAIN) {
+        errno = rc;
+        return -1;
+    }
+
+    raise_backpressure(tx);
+    switch (tx->policy) {
+    case MQ_TX_DROP_OLDEST: {
+        unsigned p;
+        ssize_t n = mq_receive(tx->mq, tx->scratch, tx->msgsize, &p);
+
+        if (n >= 0) {
+            discard(tx, tx->scratch, (size_t)n);
+            tx->dropped_oldest++;
+        }
+        if (try_send(tx, msg, len, prio) == 0)
+            return MQ_TX_SENT;
+        break;      /* the receiver cannot refill it, but be safe */
+    }
+    case MQ_TX_COALESCE:
+        memcpy(tx->parked, msg, len);
+        tx->parked_len = len;
+        tx->parked_prio = prio;
+        tx->has_parked = true;
+        return MQ_TX_PARKED;
+    case MQ_TX_DROP_NEWEST:
+        break;
+    }
+
+    discard(tx, msg, len);
+    tx->dropped_newest++;
+    return MQ_TX_DROPPED;
+}
+
+int mq_tx_flush(mq_tx *tx)
+{
+    int rc;
+
+    if (!tx->has_parked)
+        return MQ_TX_SENT;
+    rc = try_send(tx, tx->parked, tx->parked_len, tx->parked_prio);
+    if (rc == EAGAIN)
+        return MQ_TX_PARKED;
+    tx->has_parked = false;
+    if (rc == 0)
+        return MQ_TX_SENT;
+
+    discard(tx, tx->parked, tx->parked_len);
+    tx->dropped_newest++;
+    errno = rc;
+    return -1;
+}
+
+void mq_tx_set_pacing(mq_tx *tx, uint64_t initial_ns, uint64_t min_ns, uint64_t max_ns, uint64_t step_ns)
+{
+    tx->period_ns = initial_ns;
+    tx->min_period_ns = min_ns;
+    tx->max_period_ns = max_ns;
+    tx->step_ns = step_ns;
+}
+
+uint64_t mq_tx_pace(mq_tx *tx)
+{
+    struct mq_attr attr;
+    long depth;
+
+    if (mq_getattr(tx->mq, &attr) != 0)
+        return tx->period_ns;
+    depth = attr.mq_curmsgs + tx->has_parked;
+
+    if (depth >= tx->high_mark) {
+        raise_backpressure(tx);
+        if (tx->max_period_ns)
+            tx->period_ns = tx->period_ns * 2 < tx->max_period_ns ? tx->period_ns * 2 : tx->max_period_ns;
+    } else if (depth <= tx->low_mark) {
+        atomic_store_explicit(&tx->backpressure, false, memory_order_relaxed);
+        if (tx->max_period_ns)
+            tx->period_ns = tx->period_ns > tx->min_period_ns + tx->step_ns ?
+                            tx->period_ns - tx->step_ns : tx->min_period_ns;
+    }
+    return tx->period_ns;
+}
+
+int mq_tx_parse_policy(const char *name, mq_tx_policy *policy)
+{
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, policy_names[i]) == 0) {
+            *policy = (mq_tx_policy)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void mq_tx_report(FILE *out, const char *name, const mq_tx *tx)
+{
+    fprintf(out, "%s: %s, %lu sent, %lu dropped newest, %lu dropped oldest, %lu coalesced, "
+            "%lu backpressure events, period %.3f ms\n",
+            name, policy_names[tx->policy], (unsigned long)tx->sent,
+            (unsigned long)tx->dropped_newest, (unsigned long)tx->dropped_oldest,
+            (unsigned long)tx->coalesced, (unsigned long)tx->backpressure_events,
+            tx->period_ns / 1e6);
+}
@@ -0,0 +1,111 @@
+/*
+ * File: mq_tx.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Non-blocking message queue sender with backpressure and
+ *		adaptive pacing.
+ *
+ *		The queue must be opened O_RDWR | O_NONBLOCK for the sender
+ *		alone, so mq_tx_send() never blocks. When the queue is full,
+ *		the overflow policy decides which message is lost:
+ *		  drop-newest  the message being sent is discarded
+ *		  drop-oldest  the next message the receiver would get (the
+ *		               oldest of the highest priority) is taken out
+ *		               and discarded to make room
+ *		  coalesce     the message is parked; a later message replaces
+ *		               it, and the parked one goes out first once
+ *		               there is room, so the receiver gets the latest
+ *		Discarded messages go to the discard callback so the owner can
+ *		reclaim anything they reference, e.g. pooled buffers. Before a
+ *		last message that must not overtake the parked one (e.g. a
+ *		stop request), call mq_tx_flush() until it stops returning
+ *		MQ_TX_PARKED; a message still parked at mq_tx_destroy() is
+ *		discarded and counted as dropped newest.
+ *
+ *		mq_tx_pace() reads the queue depth with mq_getattr() and
+ *		returns the period until the next send. The period uses
+ *		additive decrease / multiplicative increase (AIMD): it doubles
+ *		while the queue is at or above the high mark and shrinks by a
+ *		fixed step while it is at or below the low mark. The producer
+ *		thus converges on the rate the consumer sustains. Crossing the
+ *		high mark raises the backpressure flag; it drops again at the
+ *		low mark.
+ *
+ *		Built with SHMQ_REPLACE_MQ it runs over shmq, which has a
+ *		single receiver, so drop-oldest is refused there.
+ * Date: 16th October 2026
+ */
+
+#ifndef MQ_TX_H
+#define MQ_TX_H
+
+#include <mqueue.h>
+#ifdef SHMQ_REPLACE_MQ
+#include "shmq.h"
+#endif
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum { MQ_TX_DROP_NEWEST, MQ_TX_DROP_OLDEST, MQ_TX_COALESCE } mq_tx_policy;
+
+enum { MQ_TX_SENT, MQ_TX_DROPPED, MQ_TX_PARKED };
+
+typedef void (*mq_tx_discard)(void *ctx, const char *msg, size_t len);
+
+typedef struct {
+    mqd_t mq;
+    long maxmsg;
+    size_t msgsize;
+    mq_tx_policy policy;
+    mq_tx_discard discard;
+    void *ctx;
+
+    char *parked;           /* coalesce: newest message not yet queued */
+    size_t parked_len;
+    unsigned parked_prio;
+    bool has_parked;
+    char *scratch;          /* drop-oldest: message taken back out */
+
+    long high_mark, low_mark;
+    atomic_bool backpressure;
+    uint64_t backpressure_events;
+
+    uint64_t period_ns;
+    uint64_t min_period_ns, max_period_ns, step_ns;
+
+    uint64_t sent;
+    uint64_t dropped_newest;
+    uint64_t dropped_oldest;
+    uint64_t coalesced;
+} mq_tx;
+
+/* Returns 0 or an errno value. Marks default to 3/4 and 1/4 of mq_maxmsg. */
+int mq_tx_init(mq_tx *tx, mqd_t mq, mq_tx_policy policy, mq_tx_discard discard, void *ctx);
+
+void mq_tx_destroy(mq_tx *tx);
+
+/* Never blocks. Returns MQ_TX_SENT, MQ_TX_DROPPED or MQ_TX_PARKED, or -1 with errno on a queue error. */
+int mq_tx_send(mq_tx *tx, const char *msg, size_t len, unsigned prio);
+
+/* Send the parked message, if any. Never blocks. Returns MQ_TX_SENT once nothing is parked, MQ_TX_PARKED
+ * while the queue is still full, or -1 with errno on a queue error, which drops the parked message. */
+int mq_tx_flush(mq_tx *tx);
+
+/* Enable AIMD pacing between min and max, starting at 'initial' */
+void mq_tx_set_pacing(mq_tx *tx, uint64_t initial_ns, uint64_t min_ns, uint64_t max_ns, uint64_t step_ns);
+
+/* Update backpressure and the pacing period from the queue depth. Returns the period in ns. */
+uint64_t mq_tx_pace(mq_tx *tx);
+
+static inline bool mq_tx_backpressure(mq_tx *tx)
+{
+    return atomic_load_explicit(&tx->backpressure, memory_order_relaxed);
+}
+
+/* Parse "drop-newest", "drop-oldest" or "coalesce". Returns 0, or -1 if unknown. */
+int mq_tx_parse_policy(const char *name, mq_tx_policy *policy);
+
+void mq_tx_report(FILE *out, const char *name, const mq_tx *tx);
+
+#endif /* MQ_TX_H */
@@ -0,0 +1,131 @@
+/*
+ * File: msg_desc.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Typed message descriptor shared by the Q4 queue programs.
+ *
+ *		Every message starts with a fixed header: the message type,
+ *		the payload length, an id, the sender's index (0 unless the
+ *		program has several senders, see msg_desc_set_source) and the
+ *		CLOCK_MONOTONIC time at which it was packed. Payloads of up to
+ *		MSG_DESC_INLINE_MAX bytes follow the header directly; larger
+ *		ones are copied into a buf_pool block and only the block
+ *		pointer is sent. Only the used part of the descriptor goes on
+ *		the queue (msg_desc_size), so a queue created with
+ *		mq_msgsize = sizeof(msg_desc) takes both forms.
+ *
+ *		Pool references are only meaningful inside one process. The
+ *		receiver owns a referenced block and returns it with
+ *		msg_desc_release(); a message that is dropped before it is
+ *		received must be released the same way.
+ * Date: 16th October 2026
+ */
+
+#ifndef MSG_DESC_H
+#define MSG_DESC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "buf_pool.h"
+#include "rt_time.h"
+
+#define MSG_DESC_SIZE 128       /* whole descriptor, the queue's mq_msgsize */
+
+enum { MSG_TYPE_TEXT = 1, MSG_TYPE_IMAGE, MSG_TYPE_STOP };
+
+#define MSG_DESC_REF 0x1        /* payload is in a pool block */
+
+typedef struct {
+    uint16_t type;
+    uint16_t flags;
+    uint32_t length;            /* payload bytes */
+    uint32_t id;
+    uint32_t source;            /* sender index, 0 by default */
+    uint64_t enqueue_ns;        /* CLOCK_MONOTONIC */
+} msg_desc_hdr;
+
+#define MSG_DESC_INLINE_MAX (MSG_DESC_SIZE - sizeof(msg_desc_hdr))
+
+typedef struct {
+    msg_desc_hdr hdr;
+    union {
+        char data[MSG_DESC_INLINE_MAX];
+        void *ref;
+    } payload;
+} msg_desc;
+
+_Static_assert(sizeof(msg_desc) == MSG_DESC_SIZE, "msg_desc must be MSG_DESC_SIZE bytes");
+
+/*
+ * Fill 'd' with a copy of 'data' and stamp it. Payloads too large to be
+ * inlined go into a block of 'pool' (which may be NULL if every payload
+ * fits). Returns 0, or -1 if the pool is exhausted or missing or the
+ * payload does not fit a block.
+ */
+static inline int msg_desc_pack(msg_desc *d, unsigned type, uint32_t id, const void *data,
+                                size_t len, buf_pool *pool)
+{
+    d->hdr.type = (uint16_t)type;
+    d->hdr.flags = 0;
+    d->hdr.length = (uint32_t)len;
+    d->hdr.id = id;
+    d->hdr.source = 0;
+
+    if (len <= MSG_DESC_INLINE_MAX) {
+        if (len > 0)                        /* 'data' may be NULL for an empty payload */
+            memcpy(d->payload.data, data, len);
+    } else {
+        if (pool == NULL || len > pool->block_size || (d->payload.ref = buf_pool_get(pool)) == NULL)
+            return -1;
+        memcpy(d->payload.ref, data, len);
+        d->hdr.flags = MSG_DESC_REF;
+    }
+    d->hdr.enqueue_ns = now_ns(CLOCK_MONOTONIC);
+    return 0;
+}
+
+/* Tag a packed descriptor with the index of the thread sending it */
+static inline void msg_desc_set_source(msg_desc *d, uint32_t source)
+{
+    d->hdr.source = source;
+}
+
+/* Bytes of 'd' to hand to mq_send */
+static inline size_t msg_desc_size(const msg_desc *d)
+{
+    if (d->hdr.flags & MSG_DESC_REF)
+        return sizeof(msg_desc_hdr) + sizeof(void *);
+    return sizeof(msg_desc_hdr) + d->hdr.length;
+}
+
+/* Check a received descriptor against the number of bytes mq_receive returned */
+static inline int msg_desc_valid(const msg_desc *d, ssize_t nbytes)
+{
+    return nbytes >= (ssize_t)sizeof(msg_desc_hdr) && (size_t)nbytes == msg_desc_size(d) &&
+           ((d->hdr.flags & MSG_DESC_REF) || d->hdr.length <= MSG_DESC_INLINE_MAX);
+}
+
+static inline void *msg_desc_payload(msg_desc *d)
+{
+    return (d->hdr.flags & MSG_DESC_REF) ? d->payload.ref : d->payload.data;
+}
+
+/* Time the message spent between packing and now */
+static inline uint64_t msg_desc_delay_ns(const msg_desc *d)
+{
+    return now_ns(CLOCK_MONOTONIC) - d->hdr.enqueue_ns;
+}
+
+/* Give a referenced payload block back to its pool; no-op for inline payloads */
+static inline void msg_desc_release(msg_desc *d, buf_pool *pool)
+{
+    if (d->hdr.flags & MSG_DESC_REF) {
+        buf_pool_put(pool, d->payload.ref);
+        d->hdr.flags = 0;
+    }
+}
+
+#endif /* MSG_DESC_H */
@@ -0,0 +1,228 @@
+/*
+ * File: pool_bench.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Compares malloc/free against buf_pool for heap_mq style
+ *		4 KB payload buffers.
+ *
+ *		local: one thread takes a buffer, writes the 64-byte message
+ *		into it and returns it, as fast as it can.
+ *
+ *		mq: a sender thread takes a buffer, writes it and sends its
+ *		pointer and id through a POSIX message queue, as heap_mq does.
+ *		A receiver thread receives it and returns the buffer, so every
+ *		buffer is freed on a different thread than it was allocated
+ *		on. Both threads run back to back without delays.
+ *
+ *		Each run reports the message rate and histograms of the time
+ *		spent allocating and freeing.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "buf_pool.h"
+#include "hist.h"
+#include "rt_time.h"
+
+#define BENCH_MQ "/pool_bench_mq"
+#define BUF_SIZE 4096
+#define MSG_SIZE (sizeof(void *) + sizeof(int))
+
+typedef struct {
+    const char *name;
+    void *(*get)(void);
+    void (*put)(void *buf);
+} allocator;
+
+static buf_pool pool;
+static char message[64];
+static unsigned duration_s = 5;
+static unsigned long local_ops = 1000000;
+static long queue_depth = 10;
+
+static void *malloc_get(void) { return malloc(BUF_SIZE); }
+static void malloc_put(void *buf) { free(buf); }
+static void *pool_get(void) { return buf_pool_get(&pool); }
+static void pool_put(void *buf) { buf_pool_put(&pool, buf); }
+
+static const allocator allocators[] = {
+    { "malloc", malloc_get, malloc_put },
+    { "buf_pool", pool_get, pool_put },
+};
+
+static hist_t get_lat, put_lat;
+
+static void bench_local(const allocator *a)
+{
+    uint64_t start, t0, t1;
+
+    hist_init(&get_lat);
+    hist_init(&put_lat);
+
+    start = now_ns(CLOCK_MONOTONIC);
+    for (unsigned long i = 0; i < local_ops; i++) {
+        t0 = now_ns(CLOCK_MONOTONIC);
+        char *buf = a->get();
+        t1 = now_ns(CLOCK_MONOTONIC);
+        hist_record(&get_lat, t1 - t0);
+        memcpy(buf, message, sizeof(message));
+        t0 = now_ns(CLOCK_MONOTONIC);
+        a->put(buf);
+        t1 = now_ns(CLOCK_MONOTONIC);
+        hist_record(&put_lat, t1 - t0);
+    }
+
+    printf("local %-8s %.0f ops/s\n", a->name,
+           local_ops / ((now_ns(CLOCK_MONOTONIC) - start) / 1e9));
+    hist_print(stdout, "  get", &get_lat);
+    hist_print(stdout, "  put", &put_lat);
+}
+
+static mqd_t mq;
+static atomic_bool stop;
+static uint64_t sent, received, exhausted;
+
+static void *mq_sender(void *arg)
+{
+    const allocator *a = (const allocator *)arg;
+    char msg[MSG_SIZE];
+    int id = 999;
+
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        uint64_t t0 = now_ns(CLOCK_MONOTONIC);
+        char *buf = a->get();
+        hist_record(&get_lat, now_ns(CLOCK_MONOTONIC) - t0);
+        if (buf == NULL) {
+            exhausted++;
+            sched_yield();
+            continue;
+        }
+        memcpy(buf, message, sizeof(message));
+        memcpy(msg, &buf, sizeof(void *));
+        memcpy(&msg[sizeof(void *)], &id, sizeof(int));
+        if (mq_send(mq, msg, MSG_SIZE, 30) == 0)
+            sent++;
+        else
+            a->put(buf);
+    }
+
+    /* Wake the receiver with a NULL pointer */
+    memset(msg, 0, sizeof(msg));
+    mq_send(mq, msg, MSG_SIZE, 0);
+    return NULL;
+}
+
+static void *mq_receiver(void *arg)
+{
+    const allocator *a = (const allocator *)arg;
+    char msg[MSG_SIZE];
+    void *buf;
+    unsigned prio;
+
+    for (;;) {
+        if (mq_receive(mq, msg, MSG_SIZE, &prio) != (ssize_t)MSG_SIZE)
+            continue;
+        memcpy(&buf, msg, sizeof(void *));
+        if (buf == NULL)
+            break;
+        uint64_t t0 = now_ns(CLOCK_MONOTONIC);
+        a->put(buf);
+        hist_record(&put_lat, now_ns(CLOCK_MONOTONIC) - t0);
+        received++;
+    }
+    return NULL;
+}
+
+static void bench_mq(const allocator *a)
+{
+    struct mq_attr attr = { .mq_maxmsg = queue_depth, .mq_msgsize = MSG_SIZE };
+    struct timespec duration = { duration_s, 0 };
+    pthread_t sender, receiver;
+
+    hist_init(&get_lat);
+    hist_init(&put_lat);
+    sent = received = exhausted = 0;
+    atomic_store(&stop, false);
+
+    mq_unlink(BENCH_MQ);
+    mq = mq_open(BENCH_MQ, O_CREAT | O_RDWR, 0600, &attr);
+    if (mq == (mqd_t)-1) {
+        perror("mq_open");
+        exit(1);
+    }
+
+    pthread_create(&receiver, NULL, mq_receiver, (void *)a);
+    pthread_create(&sender, NULL, mq_sender, (void *)a);
+    nanosleep(&duration, NULL);
+    atomic_store(&stop, true);
+    pthread_join(sender, NULL);
+    pthread_join(receiver, NULL);
+
+    mq_close(mq);
+    mq_unlink(BENCH_MQ);
+
+    printf("mq    %-8s %.0f msgs/s, %lu sent, %lu received, %lu exhausted\n", a->name,
+           (double)received / duration_s, (unsigned long)sent, (unsigned long)received,
+           (unsigned long)exhausted);
+    hist_print(stdout, "  get", &get_lat);
+    hist_print(stdout, "  put", &put_lat);
+}
+
+static void usage(void)
+{
+    printf("Usage: pool_bench [local|mq|all] [-n local_ops] [-d seconds] [-q queue_depth]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *which = "all";
+    int opt, rc;
+
+    if (argc > 1 && argv[1][0] != '-') {
+        which = argv[1];
+        optind = 2;
+    }
+    while ((opt = getopt(argc, argv, "n:d:q:")) != -1) {
+        switch (opt) {
+        case 'n': local_ops = strtoul(optarg, NULL, 10); break;
+        case 'd': duration_s = (unsigned)atoi(optarg); break;
+        case 'q': queue_depth = atol(optarg); break;
+        default: usage();
+        }
+    }
+    if (local_ops == 0 || duration_s == 0 || queue_depth < 1)
+        usage();
+
+    memset(message, 'A', sizeof(message) - 1);
+    /* Enough blocks for a full queue plus one held by each thread */
+    if ((rc = buf_pool_init(&pool, BUF_SIZE, (unsigned)queue_depth + 2)) != 0) {
+        fprintf(stderr, "buf_pool_init: %s\n", strerror(rc));
+        return 1;
+    }
+
+    for (unsigned i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+        if (strcmp(which, "local") == 0 || strcmp(which, "all") == 0)
+            bench_local(&allocators[i]);
+        else if (strcmp(which, "mq") != 0)
+            usage();
+    }
+    for (unsigned i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+        if (strcmp(which, "mq") == 0 || strcmp(which, "all") == 0)
+            bench_mq(&allocators[i]);
+    }
+
+    buf_pool_report(stdout, "buf_pool", &pool);
+    buf_pool_destroy(&pool);
+    return 0;
+}
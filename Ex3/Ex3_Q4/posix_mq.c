@@ -2,6 +2,12 @@
  * File: posix.c
  * Author: Krishna Suhagiya and Suhas Reddy
  * Description: This file ports the provided VxWorks posix_mq.c implementation to POSIX with SCHED_FIFO scheduling.
+ *		The canned message is sent inline in a msg_desc descriptor,
+ *		and the receiver reports how long it was queued.
+ *		Queue telemetry is published in "/rtes_posix_mq_telemetry"
+ *		(see mq_stat) and printed at exit.
+ *		Built as posix_shmq (-DSHMQ_REPLACE_MQ) it runs over shmq instead
+ *		of the kernel message queue.
  * Date: 9th March 2023
  */
 
@@ -12,16 +18,26 @@
 #include <string.h>
 #include <unistd.h>
 #include <sched.h>
+#include <errno.h>
+
+#ifdef SHMQ_REPLACE_MQ
+#include "shmq.h"   // Same mq_* calls, carried over the shared-memory queue
+#endif
+
+#include "msg_desc.h"
+#include "mq_telemetry.h"
 
 #define SNDRCV_MQ "/send_receive_mq"
-#define MAX_MSG_SIZE 128
+#define MAX_MSG_SIZE sizeof(msg_desc)
+#define POSIX_MQ_TELEMETRY_SHM "/rtes_posix_mq_telemetry"
 
 struct mq_attr mq_attr;
+static mq_telemetry_queue *telemetry;
 
 void *receiver(void *arg)
 {
     mqd_t mymq;
-    char buffer[MAX_MSG_SIZE];
+    msg_desc desc;
     int prio;
     int nbytes;
 
@@ -34,14 +50,22 @@ void *receiver(void *arg)
     }
 
     // Read oldest, highest priority message from the message queue
-    if ((nbytes = mq_receive(mymq, buffer, MAX_MSG_SIZE, &prio)) == -1)
+    if ((nbytes = mq_receive(mymq, (char *)&desc, MAX_MSG_SIZE, &prio)) == -1)
     {
         perror("mq_receive");
+        mq_telemetry_recv_error(telemetry);
+    }
+    else if (!msg_desc_valid(&desc, nbytes) || desc.hdr.type != MSG_TYPE_TEXT)
+    {
+        printf("Receiver: malformed message of %d bytes\n", nbytes);
+        mq_telemetry_recv_error(telemetry);
     }
     else
     {
-        buffer[nbytes] = '\0';
-        printf("Receiver: Message '%s' received with priority = %d, length = %d\n", buffer, prio, nbytes);
+        mq_telemetry_received(telemetry, msg_desc_delay_ns(&desc));
+        printf("Receiver: Message '%.*s' received with priority = %d, length = %u, id = %u, queued %lu us\n",
+               (int)desc.hdr.length, (char *)msg_desc_payload(&desc), prio, desc.hdr.length, desc.hdr.id,
+               (unsigned long)(msg_desc_delay_ns(&desc) / NSEC_PER_USEC));
     }
 
     // Close the message queue
@@ -54,7 +78,7 @@ static char canned_msg[] = "this is a test, and only a test, in the event of a r
 void *sender(void *arg)
 {
     mqd_t mymq;
-    int prio;
+    msg_desc desc;
     int nbytes;
 
     // Open the message queue for writing
@@ -65,14 +89,21 @@ void *sender(void *arg)
         exit(1);
     }
 
-    // Send message with priority=30
-    if ((nbytes = mq_send(mymq, canned_msg, sizeof(canned_msg), 30)) == -1)
+    // Send message with priority=30; it fits inline, so no pool is needed
+    if (msg_desc_pack(&desc, MSG_TYPE_TEXT, 1, canned_msg, sizeof(canned_msg), NULL) != 0)
+    {
+        printf("Sender: message too long to send inline\n");
+        mq_telemetry_dropped(telemetry, 1);
+    }
+    else if ((nbytes = mq_send(mymq, (const char *)&desc, msg_desc_size(&desc), 30)) == -1)
     {
         perror("mq_send");
+        mq_telemetry_send_error(telemetry);
     }
     else
     {
         printf("Sender: Message successfully sent\n");
+        mq_telemetry_sent(telemetry, 1);
     }
 
     // Close the message queue
@@ -85,6 +116,7 @@ void mq_demo(void)
     pthread_t receiver_thread, sender_thread;
     pthread_attr_t receiver_attr, sender_attr;
     struct sched_param receiver_param, sender_param;
+    mqd_t statmq;
 
     // Setup common message queue attributes
     mq_attr.mq_maxmsg = 100;
@@ -106,6 +138,20 @@ void mq_demo(void)
     pthread_attr_setschedparam(&receiver_attr, &receiver_param);
     pthread_attr_setschedparam(&sender_attr, &sender_param);
 
+    // Create the queue up front so the telemetry sampler can watch its depth
+    statmq = mq_open(SNDRCV_MQ, O_CREAT | O_RDWR, 777, &mq_attr);
+    if (statmq == (mqd_t)-1)
+    {
+        perror("mq_open");
+        exit(1);
+    }
+    telemetry = mq_telemetry_register("send_receive_mq", statmq);
+    if ((errno = mq_telemetry_start(POSIX_MQ_TELEMETRY_SHM, 100 * NSEC_PER_MSEC)) != 0)
+    {
+        perror("mq_telemetry_start");
+        exit(1);
+    }
+
     // Create receiver and sender threads with the specified attributes
     if (pthread_create(&receiver_thread, &receiver_attr, receiver, NULL) != 0)
     {
@@ -134,6 +180,10 @@ void mq_demo(void)
     // Wait for threads to complete
     pthread_join(receiver_thread, NULL);
     pthread_join(sender_thread, NULL);
+
+    mq_telemetry_stop();
+    mq_telemetry_report(stdout, telemetry);
+    mq_close(statmq);
 }
 
 int main()
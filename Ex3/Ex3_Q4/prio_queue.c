@@ -0,0 +1,179 @@
+/*
+ * File: prio_queue.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: In-process priority queue, see prio_queue.h.
+ *
+ *		A producer first reserves its message in the lane count and,
+ *		when the lane was empty, sets the lane's bitmap bit; only then
+ *		does it link the node. A set bit therefore always means a
+ *		message that is linked or about to be, and the consumer can
+ *		never take a message the count does not know about. Until the
+ *		link is done the consumer gets nothing rather than a lower
+ *		priority, so priority order holds even against a producer
+ *		preempted in the middle of a push; prio_queue_pop() then
+ *		sleeps on 'seq', which the producer bumps after linking.
+ *
+ *		The consumer clears a bit when it takes the last reserved
+ *		message of a lane and then re-reads the count, restoring the
+ *		bit if a producer reserved in between.
+ *
+ *		Sleeping uses the shmq scheme: the consumer sets its waiting
+ *		flag and looks at the bitmap again before it sleeps on 'seq';
+ *		a producer bumps 'seq' after linking and then reads the flag.
+ *		All of these are sequentially consistent, so a wakeup cannot
+ *		be missed.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "prio_queue.h"
+
+static void futex_wait(atomic_uint *addr, unsigned val)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+void prio_queue_init(prio_queue *q)
+{
+    atomic_init(&q->bitmap, 0);
+    atomic_init(&q->seq, 0);
+    atomic_init(&q->waiting, 0);
+    atomic_init(&q->wakes, 0);
+    q->sleeps = 0;
+    for (unsigned p = 0; p < PRIO_QUEUE_LEVELS; p++) {
+        prio_queue_lane *lane = &q->lanes[p];
+
+        atomic_init(&lane->stub.next, NULL);
+        atomic_init(&lane->head, &lane->stub);
+        atomic_init(&lane->count, 0);
+        lane->tail = &lane->stub;
+    }
+}
+
+static void lane_push(prio_queue_lane *lane, prio_queue_node *node)
+{
+    prio_queue_node *prev;
+
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    prev = atomic_exchange_explicit(&lane->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+/* Oldest linked node, or NULL if there is none yet */
+static prio_queue_node *lane_pop(prio_queue_lane *lane)
+{
+    prio_queue_node *tail = lane->tail;
+    prio_queue_node *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &lane->stub) {
+        if (next == NULL)
+            return NULL;
+        lane->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next != NULL) {
+        lane->tail = next;
+        return tail;
+    }
+
+    /* 'tail' is the last node; a producer may be between exchange and link */
+    if (tail != atomic_load_explicit(&lane->head, memory_order_acquire))
+        return NULL;
+
+    /* Put the stub back behind it so the last node can be handed out */
+    lane_push(lane, &lane->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        lane->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+int prio_queue_push(prio_queue *q, prio_queue_node *node, unsigned prio)
+{
+    prio_queue_lane *lane;
+
+    if (prio >= PRIO_QUEUE_LEVELS)
+        return EINVAL;
+    lane = &q->lanes[prio];
+
+    if (atomic_fetch_add(&lane->count, 1) == 0)
+        atomic_fetch_or(&q->bitmap, 1u << prio);
+    lane_push(lane, node);
+
+    atomic_fetch_add(&q->seq, 1);
+    if (atomic_load(&q->waiting)) {
+        atomic_fetch_add_explicit(&q->wakes, 1, memory_order_relaxed);
+        futex_wake(&q->seq);
+    }
+    return 0;
+}
+
+prio_queue_node *prio_queue_trypop(prio_queue *q, unsigned *prio)
+{
+    unsigned bits = atomic_load(&q->bitmap);
+    unsigned p;
+    prio_queue_lane *lane;
+    prio_queue_node *node;
+
+    if (bits == 0)
+        return NULL;
+    p = 31 - (unsigned)__builtin_clz(bits);
+    lane = &q->lanes[p];
+
+    /* NULL when reserved but not linked yet: the producer bumps 'seq' once it is */
+    if ((node = lane_pop(lane)) == NULL)
+        return NULL;
+
+    if (atomic_fetch_sub(&lane->count, 1) == 1) {
+        atomic_fetch_and(&q->bitmap, ~(1u << p));
+        if (atomic_load(&lane->count) > 0)
+            atomic_fetch_or(&q->bitmap, 1u << p);
+    }
+    if (prio != NULL)
+        *prio = p;
+    return node;
+}
+
+prio_queue_node *prio_queue_pop(prio_queue *q, unsigned *prio)
+{
+    prio_queue_node *node;
+
+    for (;;) {
+        unsigned seq = atomic_load(&q->seq);
+
+        if ((node = prio_queue_trypop(q, prio)) != NULL)
+            return node;
+
+        atomic_store(&q->waiting, 1);
+        node = prio_queue_trypop(q, prio);
+        if (node == NULL) {
+            q->sleeps++;
+            futex_wait(&q->seq, seq);
+        }
+        atomic_store(&q->waiting, 0);
+        if (node != NULL)
+            return node;
+    }
+}
+
+unsigned prio_queue_depth(prio_queue *q)
+{
+    unsigned depth = 0;
+
+    for (unsigned p = 0; p < PRIO_QUEUE_LEVELS; p++)
+        depth += atomic_load_explicit(&q->lanes[p].count, memory_order_relaxed);
+    return depth;
+}
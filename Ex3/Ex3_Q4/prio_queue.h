@@ -0,0 +1,78 @@
+/*
+ * File: prio_queue.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: In-process priority queue with the ordering of POSIX mq:
+ *		the highest priority first, FIFO within a priority.
+ *
+ *		Each priority has an intrusive lock-free multi-producer,
+ *		single-consumer list (Vyukov's MPSC queue): a push is one
+ *		atomic exchange of the list head, a pop only touches the
+ *		consumer's tail. A bitmap with one bit per non-empty priority
+ *		lets the consumer find the highest priority with a single
+ *		count-leading-zeros, so push and pop are O(1) whatever the
+ *		number of priorities.
+ *
+ *		Messages are not copied: the caller embeds a prio_queue_node
+ *		in its message (e.g. at the start of a buf_pool block) and
+ *		the same memory comes out on the other side. The queue is
+ *		unbounded and never allocates.
+ *
+ *		Any number of threads may push; only one thread may pop at a
+ *		time. A message whose producer is still in the middle of its
+ *		push holds back the lower priorities: prio_queue_trypop()
+ *		returns NULL rather than wait for it, and prio_queue_pop()
+ *		sleeps until the push completes, so the consumer never spins
+ *		on a producer it may be keeping off the CPU (SCHED_FIFO).
+ *		An empty queue makes prio_queue_pop() sleep on a futex;
+ *		producers only make the wake system call when the consumer is
+ *		actually asleep, so an uncontended push or pop makes no system
+ *		call at all.
+ * Date: 16th October 2026
+ */
+
+#ifndef PRIO_QUEUE_H
+#define PRIO_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define PRIO_QUEUE_LEVELS 32    /* priorities 0..31, like shmq */
+
+typedef struct prio_queue_node {
+    struct prio_queue_node *_Atomic next;
+} prio_queue_node;
+
+typedef struct {
+    _Alignas(64) prio_queue_node *_Atomic head;     /* producers */
+    atomic_uint count;              /* reserved by producers before linking */
+    _Alignas(64) prio_queue_node *tail;             /* consumer */
+    prio_queue_node stub;
+} prio_queue_lane;
+
+typedef struct {
+    _Alignas(64) atomic_uint bitmap;                /* bit p: priority p has messages */
+    atomic_uint seq;                /* bumped on every push; the futex word */
+    atomic_uint waiting;            /* consumer is (about to be) asleep */
+    _Atomic uint64_t wakes;         /* futex wakes made by producers */
+    _Alignas(64) uint64_t sleeps;   /* futex waits made by the consumer */
+    prio_queue_lane lanes[PRIO_QUEUE_LEVELS];
+} prio_queue;
+
+void prio_queue_init(prio_queue *q);
+
+/* Returns 0, or EINVAL if prio >= PRIO_QUEUE_LEVELS */
+int prio_queue_push(prio_queue *q, prio_queue_node *node, unsigned prio);
+
+/*
+ * Oldest node of the highest priority, or NULL if the queue is empty or
+ * that node is still being pushed. Consumer only.
+ */
+prio_queue_node *prio_queue_trypop(prio_queue *q, unsigned *prio);
+
+/* As prio_queue_trypop(), but sleeps until a node is available and linked */
+prio_queue_node *prio_queue_pop(prio_queue *q, unsigned *prio);
+
+/* Messages queued or being pushed right now */
+unsigned prio_queue_depth(prio_queue *q);
+
+#endif /* PRIO_QUEUE_H */
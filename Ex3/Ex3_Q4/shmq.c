@@ -0,0 +1,278 @@
+/*
+ * File: shmq.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Shared-memory message queue, see shmq.h.
+ *
+ *		Segment layout: a header with the geometry and the message
+ *		count, the per-priority tail indices (written by the sender),
+ *		the per-priority head indices (written by the receiver) and
+ *		then SHMQ_PRIO_MAX rings of mq_maxmsg slots. A slot is a
+ *		32-bit length followed by mq_msgsize bytes.
+ *
+ *		The sender fills a slot, publishes the lane tail and then
+ *		increments the count. The receiver reads the count first, so a
+ *		non-zero count guarantees that a lane tail shows the message.
+ *		The count is also the futex word. A side that is about to sleep
+ *		sets its waiting flag and re-checks the count; the other side
+ *		changes the count and then reads the flag. Both are sequentially
+ *		consistent, so a wakeup cannot be missed.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shmq.h"
+
+#define SHMQ_MAGIC 0x53484d51u      /* "SHMQ" */
+#define SHMQ_OPEN_WAIT_NS 1000000000L
+
+typedef struct {
+    atomic_uint magic;
+    uint32_t maxmsg;
+    uint32_t msgsize;
+    uint32_t slot_size;
+    uint64_t map_size;
+
+    _Alignas(64) atomic_uint count;
+    atomic_uint rx_waiting;
+    atomic_uint tx_waiting;
+
+    _Alignas(64) atomic_uint tail[SHMQ_PRIO_MAX];
+    _Alignas(64) atomic_uint head[SHMQ_PRIO_MAX];
+    _Alignas(64) char slots[];
+} shmq_shared;
+
+struct shmq {
+    shmq_shared *shm;
+    int oflag;
+};
+
+static void futex_wait(atomic_uint *addr, unsigned val)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static char *slot(shmq_shared *shm, unsigned prio, unsigned idx)
+{
+    return shm->slots + ((size_t)prio * shm->maxmsg + idx % shm->maxmsg) * shm->slot_size;
+}
+
+static shmq_shared *create(int fd, const struct mq_attr *attr)
+{
+    uint32_t maxmsg = attr ? (uint32_t)attr->mq_maxmsg : SHMQ_DEFAULT_MAXMSG;
+    uint32_t msgsize = attr ? (uint32_t)attr->mq_msgsize : SHMQ_DEFAULT_MSGSIZE;
+    uint32_t slot_size;
+    size_t size;
+    shmq_shared *shm;
+
+    if (attr && (attr->mq_maxmsg <= 0 || attr->mq_msgsize <= 0)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    slot_size = (sizeof(uint32_t) + msgsize + 7) & ~7u;
+    size = sizeof(shmq_shared) + (size_t)SHMQ_PRIO_MAX * maxmsg * slot_size;
+
+    if (ftruncate(fd, (off_t)size) != 0)
+        return NULL;
+    shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm == MAP_FAILED)
+        return NULL;
+
+    /* A fresh segment is zero-filled, so only the geometry needs setting */
+    shm->maxmsg = maxmsg;
+    shm->msgsize = msgsize;
+    shm->slot_size = slot_size;
+    shm->map_size = size;
+    atomic_store_explicit(&shm->magic, SHMQ_MAGIC, memory_order_release);
+    return shm;
+}
+
+static shmq_shared *attach(int fd)
+{
+    struct timespec pause = { 0, 1000000 };
+    shmq_shared *hdr, *shm;
+    struct stat st;
+    size_t size;
+
+    /* The creator may still be sizing and initializing the segment */
+    for (long waited = 0;; waited += pause.tv_nsec) {
+        if (fstat(fd, &st) != 0)
+            return NULL;
+        if ((size_t)st.st_size >= sizeof(shmq_shared)) {
+            hdr = mmap(NULL, sizeof(shmq_shared), PROT_READ, MAP_SHARED, fd, 0);
+            if (hdr == MAP_FAILED)
+                return NULL;
+            if (atomic_load_explicit(&hdr->magic, memory_order_acquire) == SHMQ_MAGIC)
+                break;
+            munmap(hdr, sizeof(shmq_shared));
+        }
+        if (waited >= SHMQ_OPEN_WAIT_NS) {
+            errno = EPROTO;
+            return NULL;
+        }
+        nanosleep(&pause, NULL);
+    }
+
+    size = hdr->map_size;
+    munmap(hdr, sizeof(shmq_shared));
+    shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return shm == MAP_FAILED ? NULL : shm;
+}
+
+shmq_t *shmq_open(const char *name, int oflag, mode_t mode, const struct mq_attr *attr)
+{
+    shmq_shared *shm;
+    shmq_t *q;
+    int fd = -1, err;
+
+    if (oflag & O_CREAT) {
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, mode);
+        if (fd < 0 && (errno != EEXIST || (oflag & O_EXCL)))
+            return SHMQ_FAILED;
+    }
+
+    if (fd >= 0) {
+        shm = create(fd, attr);
+    } else {
+        fd = shm_open(name, O_RDWR, 0);
+        if (fd < 0)
+            return SHMQ_FAILED;
+        shm = attach(fd);
+    }
+    err = errno;
+    close(fd);
+    if (shm == NULL) {
+        errno = err;
+        return SHMQ_FAILED;
+    }
+
+    q = malloc(sizeof(*q));
+    if (q == NULL) {
+        munmap(shm, shm->map_size);
+        errno = ENOMEM;
+        return SHMQ_FAILED;
+    }
+    q->shm = shm;
+    q->oflag = oflag;
+    return q;
+}
+
+int shmq_close(shmq_t *q)
+{
+    munmap(q->shm, q->shm->map_size);
+    free(q);
+    return 0;
+}
+
+int shmq_unlink(const char *name)
+{
+    return shm_unlink(name);
+}
+
+int shmq_send(shmq_t *q, const char *msg, size_t len, unsigned prio)
+{
+    shmq_shared *shm = q->shm;
+    unsigned tail;
+    char *s;
+
+    if (prio >= SHMQ_PRIO_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (len > shm->msgsize) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    /* Only this thread adds messages, so the count cannot grow behind our back */
+    while (atomic_load_explicit(&shm->count, memory_order_acquire) >= shm->maxmsg) {
+        if (q->oflag & O_NONBLOCK) {
+            errno = EAGAIN;
+            return -1;
+        }
+        atomic_store(&shm->tx_waiting, 1);
+        if (atomic_load(&shm->count) >= shm->maxmsg)
+            futex_wait(&shm->count, shm->maxmsg);
+        atomic_store(&shm->tx_waiting, 0);
+    }
+
+    tail = atomic_load_explicit(&shm->tail[prio], memory_order_relaxed);
+    s = slot(shm, prio, tail);
+    memcpy(s, &(uint32_t){ (uint32_t)len }, sizeof(uint32_t));
+    memcpy(s + sizeof(uint32_t), msg, len);
+    atomic_store_explicit(&shm->tail[prio], tail + 1, memory_order_release);
+
+    atomic_fetch_add(&shm->count, 1);
+    if (atomic_load(&shm->rx_waiting))
+        futex_wake(&shm->count);
+    return 0;
+}
+
+ssize_t shmq_receive(shmq_t *q, char *msg, size_t len, unsigned *prio)
+{
+    shmq_shared *shm = q->shm;
+    unsigned head, lane;
+    uint32_t msglen;
+    char *s;
+
+    if (len < shm->msgsize) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    while (atomic_load_explicit(&shm->count, memory_order_acquire) == 0) {
+        if (q->oflag & O_NONBLOCK) {
+            errno = EAGAIN;
+            return -1;
+        }
+        atomic_store(&shm->rx_waiting, 1);
+        if (atomic_load(&shm->count) == 0)
+            futex_wait(&shm->count, 0);
+        atomic_store(&shm->rx_waiting, 0);
+    }
+
+    /* Highest non-empty priority; the count guarantees one exists */
+    for (lane = SHMQ_PRIO_MAX - 1;; lane--) {
+        head = atomic_load_explicit(&shm->head[lane], memory_order_relaxed);
+        if (atomic_load_explicit(&shm->tail[lane], memory_order_acquire) != head)
+            break;
+    }
+
+    s = slot(shm, lane, head);
+    memcpy(&msglen, s, sizeof(uint32_t));
+    memcpy(msg, s + sizeof(uint32_t), msglen);
+    atomic_store_explicit(&shm->head[lane], head + 1, memory_order_release);
+
+    atomic_fetch_sub(&shm->count, 1);
+    if (atomic_load(&shm->tx_waiting))
+        futex_wake(&shm->count);
+
+    if (prio != NULL)
+        *prio = lane;
+    return (ssize_t)msglen;
+}
+
+int shmq_getattr(shmq_t *q, struct mq_attr *attr)
+{
+    memset(attr, 0, sizeof(*attr));
+    attr->mq_flags = q->oflag & O_NONBLOCK;
+    attr->mq_maxmsg = q->shm->maxmsg;
+    attr->mq_msgsize = q->shm->msgsize;
+    attr->mq_curmsgs = atomic_load(&q->shm->count);
+    return 0;
+}
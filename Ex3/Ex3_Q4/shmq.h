@@ -0,0 +1,73 @@
+/*
+ * File: shmq.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Shared-memory message queue with the open/send/receive
+ *		semantics of POSIX mqueue.
+ *
+ *		The queue lives in a shm_open() segment, so it works between
+ *		threads and between processes. Messages of up to mq_msgsize
+ *		bytes are copied into the segment; receive returns the oldest
+ *		message of the highest priority, like mq_receive(). Each
+ *		priority has its own single-producer/single-consumer ring of
+ *		mq_maxmsg slots, and a shared message count caps the total at
+ *		mq_maxmsg. Sending and receiving are plain memory operations.
+ *		The only system calls are futex waits when the queue is empty
+ *		(receiver) or full (sender), and a futex wake when the other
+ *		side is actually waiting.
+ *
+ *		Differences from mqueue: at most one sending thread and one
+ *		receiving thread at a time, priorities below SHMQ_PRIO_MAX,
+ *		and no notification or timed variants.
+ *
+ *		Defining SHMQ_REPLACE_MQ before including this header maps the
+ *		mq_* calls and mqd_t onto shmq, so an mqueue program builds
+ *		against it unchanged.
+ * Date: 16th October 2026
+ */
+
+#ifndef SHMQ_H
+#define SHMQ_H
+
+#include <fcntl.h>
+#include <mqueue.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define SHMQ_PRIO_MAX       32
+#define SHMQ_DEFAULT_MAXMSG 10
+#define SHMQ_DEFAULT_MSGSIZE 8192
+
+typedef struct shmq shmq_t;
+
+#define SHMQ_FAILED ((shmq_t *)-1)
+
+/*
+ * Open or create a queue. oflag takes O_CREAT, O_EXCL and O_NONBLOCK;
+ * the queue is always opened for both sending and receiving. 'attr' may
+ * be NULL for the defaults. Returns SHMQ_FAILED and sets errno on failure.
+ */
+shmq_t *shmq_open(const char *name, int oflag, mode_t mode, const struct mq_attr *attr);
+
+int shmq_close(shmq_t *q);
+
+int shmq_unlink(const char *name);
+
+/* Returns 0, or -1 with errno EAGAIN (full, O_NONBLOCK), EMSGSIZE or EINVAL */
+int shmq_send(shmq_t *q, const char *msg, size_t len, unsigned prio);
+
+/* Returns the message length, or -1 with errno EAGAIN (empty, O_NONBLOCK) or EMSGSIZE */
+ssize_t shmq_receive(shmq_t *q, char *msg, size_t len, unsigned *prio);
+
+int shmq_getattr(shmq_t *q, struct mq_attr *attr);
+
+#ifdef SHMQ_REPLACE_MQ
+#define mqd_t shmq_t *
+#define mq_open shmq_open
+#define mq_close shmq_close
+#define mq_unlink shmq_unlink
+#define mq_send shmq_send
+#define mq_receive(q, msg, len, prio) shmq_receive(q, msg, len, (unsigned *)(prio))
+#define mq_getattr shmq_getattr
+#endif
+
+#endif /* SHMQ_H */
@@ -0,0 +1,230 @@
+/*
+ * File: shmq_bench.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Side-by-side benchmark of the kernel POSIX message queue
+ *		and shmq.
+ *
+ *		latency: ping-pong over two queues. The measuring side sends a
+ *		timestamped message and the peer echoes it back on the second
+ *		queue; half of each round trip is recorded.
+ *
+ *		throughput: the peer streams messages as fast as the queue
+ *		accepts them and the measuring side receives them, giving
+ *		messages/sec and the send-to-receive latency of each message.
+ *
+ *		The peer runs in a thread, or in a forked process with -p.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shmq.h"
+#include "hist.h"
+#include "rt_time.h"
+
+#define PING_Q "/shmq_bench_ping"
+#define PONG_Q "/shmq_bench_pong"
+
+typedef struct {
+    const char *name;
+    void *(*open)(const char *name, int oflag, struct mq_attr *attr);
+    int (*send)(void *q, const char *msg, size_t len, unsigned prio);
+    ssize_t (*receive)(void *q, char *msg, size_t len, unsigned *prio);
+    void (*close)(void *q);
+    void (*unlink)(const char *name);
+} transport;
+
+static void *kmq_open(const char *name, int oflag, struct mq_attr *attr)
+{
+    mqd_t q = mq_open(name, oflag, 0600, attr);
+    return q == (mqd_t)-1 ? NULL : (void *)(intptr_t)q;
+}
+static int kmq_send(void *q, const char *msg, size_t len, unsigned prio)
+{
+    return mq_send((mqd_t)(intptr_t)q, msg, len, prio);
+}
+static ssize_t kmq_receive(void *q, char *msg, size_t len, unsigned *prio)
+{
+    return mq_receive((mqd_t)(intptr_t)q, msg, len, prio);
+}
+static void kmq_close(void *q) { mq_close((mqd_t)(intptr_t)q); }
+static void kmq_unlink(const char *name) { mq_unlink(name); }
+
+static void *sq_open(const char *name, int oflag, struct mq_attr *attr)
+{
+    shmq_t *q = shmq_open(name, oflag, 0600, attr);
+    return q == SHMQ_FAILED ? NULL : q;
+}
+static int sq_send(void *q, const char *msg, size_t len, unsigned prio)
+{
+    return shmq_send(q, msg, len, prio);
+}
+static ssize_t sq_receive(void *q, char *msg, size_t len, unsigned *prio)
+{
+    return shmq_receive(q, msg, len, prio);
+}
+static void sq_close(void *q) { shmq_close(q); }
+static void sq_unlink(const char *name) { shmq_unlink(name); }
+
+static const transport transports[] = {
+    { "mqueue", kmq_open, kmq_send, kmq_receive, kmq_close, kmq_unlink },
+    { "shmq", sq_open, sq_send, sq_receive, sq_close, sq_unlink },
+};
+
+static size_t msg_size = 64;
+static long queue_depth = 10;
+static unsigned long count = 200000;
+static int use_fork;
+
+typedef enum { BENCH_LATENCY, BENCH_THROUGHPUT } bench_kind;
+
+typedef struct {
+    const transport *t;
+    bench_kind kind;
+} peer_arg;
+
+/* Echo pings back (latency) or stream timestamped messages (throughput) */
+static void *peer(void *arg)
+{
+    peer_arg *pa = (peer_arg *)arg;
+    const transport *t = pa->t;
+    char *msg = calloc(1, msg_size);
+    void *ping = t->open(PING_Q, O_RDWR, NULL);
+    void *pong = t->open(PONG_Q, O_RDWR, NULL);
+    unsigned prio;
+
+    if (ping == NULL || pong == NULL) {
+        perror("peer open");
+        exit(1);
+    }
+
+    for (unsigned long i = 0; i < count; i++) {
+        if (pa->kind == BENCH_LATENCY) {
+            ssize_t n = t->receive(ping, msg, msg_size, &prio);
+            t->send(pong, msg, (size_t)n, prio);
+        } else {
+            uint64_t now = now_ns(CLOCK_MONOTONIC);
+            memcpy(msg, &now, sizeof(now));
+            t->send(pong, msg, msg_size, 1);
+        }
+    }
+
+    t->close(ping);
+    t->close(pong);
+    free(msg);
+    return NULL;
+}
+
+static void run(const transport *t, bench_kind kind)
+{
+    struct mq_attr attr = { .mq_maxmsg = queue_depth, .mq_msgsize = (long)msg_size };
+    static hist_t lat;
+    peer_arg pa = { t, kind };
+    char *msg = calloc(1, msg_size);
+    pthread_t thread;
+    pid_t child = 0;
+    uint64_t start, elapsed;
+    void *ping, *pong;
+    unsigned prio;
+
+    t->unlink(PING_Q);
+    t->unlink(PONG_Q);
+    ping = t->open(PING_Q, O_CREAT | O_RDWR, &attr);
+    pong = t->open(PONG_Q, O_CREAT | O_RDWR, &attr);
+    if (ping == NULL || pong == NULL) {
+        perror(t->name);
+        exit(1);
+    }
+    hist_init(&lat);
+
+    if (use_fork) {
+        child = fork();
+        if (child == 0) {
+            peer(&pa);
+            _exit(0);
+        }
+    } else {
+        pthread_create(&thread, NULL, peer, &pa);
+    }
+
+    start = now_ns(CLOCK_MONOTONIC);
+    for (unsigned long i = 0; i < count; i++) {
+        uint64_t sent;
+
+        if (kind == BENCH_LATENCY) {
+            sent = now_ns(CLOCK_MONOTONIC);
+            memcpy(msg, &sent, sizeof(sent));
+            t->send(ping, msg, msg_size, 1);
+            t->receive(pong, msg, msg_size, &prio);
+            hist_record(&lat, (now_ns(CLOCK_MONOTONIC) - sent) / 2);
+        } else {
+            t->receive(pong, msg, msg_size, &prio);
+            memcpy(&sent, msg, sizeof(sent));
+            hist_record(&lat, now_ns(CLOCK_MONOTONIC) - sent);
+        }
+    }
+    elapsed = now_ns(CLOCK_MONOTONIC) - start;
+
+    if (use_fork)
+        waitpid(child, NULL, 0);
+    else
+        pthread_join(thread, NULL);
+
+    printf("%-10s %-7s %s %zu B: %.0f msgs/s\n", kind == BENCH_LATENCY ? "latency" : "throughput",
+           t->name, use_fork ? "process" : "thread", msg_size, count / (elapsed / 1e9));
+    hist_print(stdout, kind == BENCH_LATENCY ? "  one-way (rtt/2)" : "  send to receive", &lat);
+
+    t->close(ping);
+    t->close(pong);
+    t->unlink(PING_Q);
+    t->unlink(PONG_Q);
+    free(msg);
+}
+
+static void usage(void)
+{
+    printf("Usage: shmq_bench [latency|throughput|all] [-n messages] [-s msg_size] [-q depth] [-p]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *which = "all";
+    int opt;
+
+    if (argc > 1 && argv[1][0] != '-') {
+        which = argv[1];
+        optind = 2;
+    }
+    while ((opt = getopt(argc, argv, "n:s:q:p")) != -1) {
+        switch (opt) {
+        case 'n': count = strtoul(optarg, NULL, 10); break;
+        case 's': msg_size = strtoul(optarg, NULL, 10); break;
+        case 'q': queue_depth = atol(optarg); break;
+        case 'p': use_fork = 1; break;
+        default: usage();
+        }
+    }
+    if (count == 0 || msg_size < sizeof(uint64_t) || queue_depth < 1)
+        usage();
+    if (strcmp(which, "latency") != 0 && strcmp(which, "throughput") != 0 && strcmp(which, "all") != 0)
+        usage();
+
+    for (unsigned i = 0; i < sizeof(transports) / sizeof(transports[0]); i++) {
+        if (strcmp(which, "throughput") != 0)
+            run(&transports[i], BENCH_LATENCY);
+        if (strcmp(which, "latency") != 0)
+            run(&transports[i], BENCH_THROUGHPUT);
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * File: staleness.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: timerfd based staleness watchdog, see staleness.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "staleness.h"
+
+static void arm_at(staleness_monitor *mon, uint64_t deadline_ns)
+{
+    struct itimerspec its = { { 0, 0 }, ns_to_ts(deadline_ns) };
+
+    timerfd_settime(mon->tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void *monitor(void *arg)
+{
+    staleness_monitor *mon = (staleness_monitor *)arg;
+    struct pollfd fds[2] = { { mon->tfd, POLLIN, 0 }, { mon->efd, POLLIN, 0 } };
+    uint64_t expirations;
+
+    arm_at(mon, atomic_load(&mon->last_update_ns) + mon->threshold_ns);
+
+    while (poll(fds, 2, -1) >= 0 || errno == EINTR) {
+        uint64_t now, last;
+
+        if ((fds[1].revents & POLLIN) || atomic_load(&mon->stop))
+            break;
+        if (!(fds[0].revents & POLLIN) ||
+            read(mon->tfd, &expirations, sizeof(expirations)) != sizeof(expirations))
+            continue;
+
+        now = now_ns(CLOCK_MONOTONIC);
+        last = atomic_load_explicit(&mon->last_update_ns, memory_order_acquire);
+        if (now < last + mon->threshold_ns) {
+            /* An update arrived since the timer was armed */
+            arm_at(mon, last + mon->threshold_ns);
+            continue;
+        }
+
+        mon->alarms++;
+        if (now - last > mon->max_age_ns)
+            mon->max_age_ns = now - last;
+        mon->on_stale(now - last, mon->arg);
+        arm_at(mon, now + mon->threshold_ns);
+    }
+    return NULL;
+}
+
+int staleness_start(staleness_monitor *mon, uint64_t threshold_ns, staleness_cb on_stale, void *arg)
+{
+    int rc;
+
+    mon->threshold_ns = threshold_ns;
+    mon->on_stale = on_stale;
+    mon->arg = arg;
+    mon->alarms = 0;
+    mon->max_age_ns = 0;
+    atomic_store(&mon->stop, false);
+    atomic_store(&mon->version, 0);
+    atomic_store(&mon->last_update_ns, now_ns(CLOCK_MONOTONIC));
+
+    mon->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (mon->tfd < 0)
+        return errno;
+    mon->efd = eventfd(0, EFD_CLOEXEC);
+    if (mon->efd < 0) {
+        rc = errno;
+        close(mon->tfd);
+        return rc;
+    }
+
+    rc = pthread_create(&mon->thread, NULL, monitor, mon);
+    if (rc != 0) {
+        close(mon->efd);
+        close(mon->tfd);
+    }
+    return rc;
+}
+
+void staleness_stop(staleness_monitor *mon)
+{
+    uint64_t one = 1;
+
+    atomic_store(&mon->stop, true);
+    /* Not the timer: the monitor may be about to re-arm it */
+    if (write(mon->efd, &one, sizeof(one)) != sizeof(one))
+        perror("staleness_stop");
+    pthread_join(mon->thread, NULL);
+    close(mon->efd);
+    close(mon->tfd);
+}
+
+void staleness_report(FILE *out, const char *name, const staleness_monitor *mon)
+{
+    fprintf(out, "%s: %lu stale alarms, threshold %.3f ms, max age %.3f ms, %lu updates\n", name,
+            (unsigned long)mon->alarms, mon->threshold_ns / 1e6, mon->max_age_ns / 1e6,
+            (unsigned long)atomic_load(&mon->version));
+}
@@ -0,0 +1,68 @@
+/*
+ * File: staleness.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Event-driven staleness watchdog for published data.
+ *
+ *		The publisher calls staleness_touch() after every update,
+ *		which stores the CLOCK_MONOTONIC publication time and bumps a
+ *		version counter. No lock is taken on either side. The monitor
+ *		thread sleeps on a timerfd armed for last update + threshold.
+ *		When the timer expires and no newer update has arrived, it
+ *		calls the stale callback with the data age and re-arms one
+ *		threshold later, so the callback repeats while the data stays
+ *		stale. staleness_stop() wakes it through an eventfd polled
+ *		together with the timerfd, so it never waits for the timer.
+ * Date: 16th October 2026
+ */
+
+#ifndef STALENESS_H
+#define STALENESS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "rt_time.h"
+
+typedef void (*staleness_cb)(uint64_t age_ns, void *arg);
+
+typedef struct {
+    _Atomic uint64_t last_update_ns;    /* CLOCK_MONOTONIC */
+    _Atomic uint64_t version;
+    uint64_t threshold_ns;
+    staleness_cb on_stale;
+    void *arg;
+
+    int tfd;
+    int efd;                            /* written by staleness_stop() */
+    pthread_t thread;
+    atomic_bool stop;
+    uint64_t alarms;
+    uint64_t max_age_ns;                /* largest age reported to on_stale */
+} staleness_monitor;
+
+/* Publisher side: record an update now */
+static inline void staleness_touch(staleness_monitor *mon)
+{
+    atomic_store_explicit(&mon->last_update_ns, now_ns(CLOCK_MONOTONIC), memory_order_relaxed);
+    atomic_fetch_add_explicit(&mon->version, 1, memory_order_release);
+}
+
+/* Age of the last update in nanoseconds */
+static inline uint64_t staleness_age_ns(staleness_monitor *mon)
+{
+    return now_ns(CLOCK_MONOTONIC) - atomic_load_explicit(&mon->last_update_ns, memory_order_acquire);
+}
+
+/* Start watching. The clock starts now, as if an update was just made. Returns 0 or an errno value. */
+int staleness_start(staleness_monitor *mon, uint64_t threshold_ns, staleness_cb on_stale, void *arg);
+
+void staleness_stop(staleness_monitor *mon);
+
+/* Print the number of alarms and the largest data age seen */
+void staleness_report(FILE *out, const char *name, const staleness_monitor *mon);
+
+#endif /* STALENESS_H */
@@ -0,0 +1,407 @@
+/*
+ * File: binlog.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Deferred-formatting binary logger, see binlog.h.
+ *
+ *		Each thread owns one byte ring. A record is a binlog_rec
+ *		header, one 8-byte slot per argument and then the bytes of
+ *		any string arguments; string slots hold the copied length.
+ *		Records never wrap. When the space left before the end of
+ *		the ring is too small, the producer writes a header with a
+ *		NULL descriptor that tells the consumer to skip to offset 0.
+ *		If even a header does not fit, the consumer skips
+ *		implicitly.
+ *
+ *		Rings are pushed onto a global list and never freed. When a
+ *		thread exits its ring is marked free and the next new thread
+ *		reuses it.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "binlog.h"
+#include "rt_time.h"
+
+#define BINLOG_MASK (BINLOG_BUF_SIZE - 1)
+#define BINLOG_ALIGN(n) (((n) + 7) & ~(size_t)7)
+#define BINLOG_IDLE_NS (1 * NSEC_PER_MSEC)
+
+typedef struct {
+    const binlog_fmt *fmt;      /* NULL: skip to the start of the ring */
+    uint64_t timestamp;
+    uint32_t size;              /* whole record, multiple of 8 */
+    uint32_t reserved;
+} binlog_rec;
+
+typedef struct binlog_buf {
+    _Alignas(64) atomic_size_t tail;    /* producer */
+    size_t head_cache;
+    _Atomic uint64_t dropped;
+
+    _Alignas(64) atomic_size_t head;    /* consumer */
+
+    struct binlog_buf *next;
+    atomic_bool in_use;
+    _Alignas(64) char data[BINLOG_BUF_SIZE];
+} binlog_buf;
+
+static _Atomic(binlog_buf *) buf_list;
+static __thread binlog_buf *tls_buf;
+static pthread_key_t tls_key;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+
+static FILE *log_out;
+static pthread_t writer_thread;
+static atomic_bool running;
+static atomic_bool stopping;
+
+static void release_buf(void *arg)
+{
+    binlog_buf *buf = (binlog_buf *)arg;
+
+    atomic_store_explicit(&buf->in_use, false, memory_order_release);
+}
+
+static void make_key(void)
+{
+    pthread_key_create(&tls_key, release_buf);
+}
+
+static binlog_buf *claim_buf(void)
+{
+    binlog_buf *buf;
+
+    pthread_once(&key_once, make_key);
+
+    /* Reuse the ring of a thread that has exited */
+    for (buf = atomic_load(&buf_list); buf != NULL; buf = buf->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&buf->in_use, &expected, true))
+            break;
+    }
+
+    if (buf == NULL) {
+        buf = aligned_alloc(64, sizeof(*buf));
+        if (buf == NULL)
+            return NULL;
+        memset(buf, 0, sizeof(*buf));       /* also prefaults the ring */
+        atomic_store(&buf->in_use, true);
+        buf->next = atomic_load(&buf_list);
+        while (!atomic_compare_exchange_weak(&buf_list, &buf->next, buf))
+            ;
+    }
+
+    pthread_setspecific(tls_key, buf);
+    tls_buf = buf;
+    return buf;
+}
+
+void binlog_thread_init(void)
+{
+    if (tls_buf == NULL)
+        claim_buf();
+}
+
+uint64_t binlog_dropped(void)
+{
+    uint64_t total = 0;
+
+    for (binlog_buf *buf = atomic_load(&buf_list); buf != NULL; buf = buf->next)
+        total += atomic_load_explicit(&buf->dropped, memory_order_relaxed);
+    return total;
+}
+
+static size_t string_len(const char *s)
+{
+    if (s == NULL)
+        return 6;               /* "(null)" */
+    return strnlen(s, BINLOG_MAX_STR);
+}
+
+/* Format one record. 'slots' holds the argument slots, 'strings' the copied bytes. */
+static void format_record(FILE *out, const binlog_fmt *fmt, const binlog_arg *slots,
+                          const char *strings)
+{
+    const char *p = fmt->fmt;
+    unsigned argi = 0;
+
+    while (*p) {
+        const char *start = p;
+        char spec[32];
+        size_t speclen = 0;
+        char conv;
+
+        if (*p != '%') {
+            while (*p && *p != '%')
+                p++;
+            fwrite(start, 1, (size_t)(p - start), out);
+            continue;
+        }
+        if (p[1] == '%') {
+            fputc('%', out);
+            p += 2;
+            continue;
+        }
+
+        /* Copy flags, width and precision; drop length modifiers */
+        spec[speclen++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && speclen < sizeof(spec) - 4)
+            spec[speclen++] = *p++;
+        while (*p && strchr("hlLqjzt", *p))
+            p++;
+        conv = *p;
+        if (conv == '\0' || argi >= fmt->nargs) {
+            p = start;          /* print the rest verbatim */
+            break;
+        }
+        p++;
+
+        switch (conv) {
+        case 'd': case 'i':
+            memcpy(&spec[speclen], "ll", 2);
+            spec[speclen + 2] = conv;
+            spec[speclen + 3] = '\0';
+            fprintf(out, spec, (long long)slots[argi].i);
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            memcpy(&spec[speclen], "ll", 2);
+            spec[speclen + 2] = conv;
+            spec[speclen + 3] = '\0';
+            fprintf(out, spec, (unsigned long long)slots[argi].u);
+            break;
+        case 'c':
+            spec[speclen] = conv;
+            spec[speclen + 1] = '\0';
+            fprintf(out, spec, (int)slots[argi].i);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec[speclen] = conv;
+            spec[speclen + 1] = '\0';
+            fprintf(out, spec, slots[argi].d);
+            break;
+        case 's': {
+            /* Copied string: the slot holds its length */
+            size_t len = strings != NULL ? slots[argi].u : string_len(slots[argi].s);
+            char *dot;
+
+            /* The length goes in as the precision, so fold in any precision of the caller's */
+            spec[speclen] = '\0';
+            if ((dot = strchr(spec, '.')) != NULL) {
+                size_t prec = strtoul(dot + 1, NULL, 10);
+                if (prec < len)
+                    len = prec;
+                speclen = (size_t)(dot - spec);
+            }
+            spec[speclen] = '.';
+            spec[speclen + 1] = '*';
+            spec[speclen + 2] = 's';
+            spec[speclen + 3] = '\0';
+            if (strings != NULL) {
+                fprintf(out, spec, (int)len, strings);
+                strings += slots[argi].u;
+            } else {
+                fprintf(out, spec, (int)len, slots[argi].s ? slots[argi].s : "(null)");
+            }
+            break;
+        }
+        case 'p':
+            fprintf(out, "%p", slots[argi].p);
+            break;
+        default:
+            fwrite(start, 1, (size_t)(p - start), out);
+            break;
+        }
+        argi++;
+    }
+    if (*p)
+        fputs(p, out);
+}
+
+void binlog_write(const binlog_fmt *fmt, const binlog_arg *args)
+{
+    binlog_buf *buf = tls_buf;
+    size_t strlens[BINLOG_MAX_ARGS];
+    size_t size, skip, tail, pos;
+    binlog_rec *rec;
+    binlog_arg *slots;
+    char *strings;
+
+    if (!atomic_load_explicit(&running, memory_order_acquire)) {
+        format_record(stdout, fmt, args, NULL);
+        return;
+    }
+
+    size = sizeof(binlog_rec) + fmt->nargs * sizeof(binlog_arg);
+    for (unsigned i = 0; i < fmt->nargs; i++) {
+        if (fmt->types[i] == BINLOG_STR) {
+            strlens[i] = string_len(args[i].s);
+            size += strlens[i];
+        }
+    }
+    size = BINLOG_ALIGN(size);
+
+    if (buf == NULL && (buf = claim_buf()) == NULL)
+        return;
+
+    /* Records are contiguous, so one that does not fit wastes the end of the ring */
+    tail = atomic_load_explicit(&buf->tail, memory_order_relaxed);
+    pos = tail & BINLOG_MASK;
+    skip = BINLOG_BUF_SIZE - pos < size ? BINLOG_BUF_SIZE - pos : 0;
+
+    if (BINLOG_BUF_SIZE - (tail - buf->head_cache) < skip + size) {
+        buf->head_cache = atomic_load_explicit(&buf->head, memory_order_acquire);
+        if (BINLOG_BUF_SIZE - (tail - buf->head_cache) < skip + size) {
+            atomic_store_explicit(&buf->dropped,
+                                  atomic_load_explicit(&buf->dropped, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+            return;
+        }
+    }
+
+    if (skip) {
+        if (skip >= sizeof(binlog_rec)) {
+            rec = (binlog_rec *)&buf->data[pos];
+            rec->fmt = NULL;
+            rec->size = (uint32_t)skip;
+        }
+        pos = 0;
+    }
+
+    rec = (binlog_rec *)&buf->data[pos];
+    rec->fmt = fmt;
+    rec->timestamp = now_ns(CLOCK_MONOTONIC);
+    rec->size = (uint32_t)size;
+    slots = (binlog_arg *)(rec + 1);
+    strings = (char *)(slots + fmt->nargs);
+    for (unsigned i = 0; i < fmt->nargs; i++) {
+        if (fmt->types[i] == BINLOG_STR) {
+            memcpy(strings, args[i].s ? args[i].s : "(null)", strlens[i]);
+            strings += strlens[i];
+            slots[i].u = strlens[i];
+        } else {
+            slots[i] = args[i];
+        }
+    }
+
+    atomic_store_explicit(&buf->tail, tail + skip + size, memory_order_release);
+}
+
+/* Oldest unread record of 'buf', skipping wrap markers, or NULL when empty */
+static binlog_rec *peek_record(binlog_buf *buf)
+{
+    size_t head = atomic_load_explicit(&buf->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&buf->tail, memory_order_acquire);
+
+    while (head != tail) {
+        size_t pos = head & BINLOG_MASK;
+        binlog_rec *rec = (binlog_rec *)&buf->data[pos];
+
+        if (BINLOG_BUF_SIZE - pos < sizeof(binlog_rec)) {
+            head += BINLOG_BUF_SIZE - pos;
+        } else if (rec->fmt == NULL) {
+            head += rec->size;
+        } else {
+            atomic_store_explicit(&buf->head, head, memory_order_release);
+            return rec;
+        }
+    }
+    atomic_store_explicit(&buf->head, head, memory_order_release);
+    return NULL;
+}
+
+/* Format pending records from all rings in timestamp order. Returns how many. */
+static size_t drain(void)
+{
+    size_t written = 0;
+
+    for (;;) {
+        binlog_buf *oldest_buf = NULL;
+        binlog_rec *oldest = NULL;
+
+        for (binlog_buf *buf = atomic_load(&buf_list); buf != NULL; buf = buf->next) {
+            binlog_rec *rec = peek_record(buf);
+            if (rec != NULL && (oldest == NULL || rec->timestamp < oldest->timestamp)) {
+                oldest = rec;
+                oldest_buf = buf;
+            }
+        }
+        if (oldest == NULL)
+            return written;
+
+        const binlog_arg *slots = (const binlog_arg *)(oldest + 1);
+        format_record(log_out, oldest->fmt, slots, (const char *)(slots + oldest->fmt->nargs));
+        atomic_store_explicit(&oldest_buf->head,
+                              atomic_load_explicit(&oldest_buf->head, memory_order_relaxed) + oldest->size,
+                              memory_order_release);
+        written++;
+    }
+}
+
+static void *writer(void *arg)
+{
+    struct timespec idle = ns_to_ts(BINLOG_IDLE_NS);
+    struct sched_param param = { .sched_priority = 0 };
+
+    (void)arg;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+
+    while (!atomic_load(&stopping)) {
+        if (drain() > 0)
+            fflush(log_out);
+        else
+            nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+int binlog_init(FILE *out)
+{
+    pthread_attr_t attr;
+    struct sched_param param = { .sched_priority = 0 };
+    int rc;
+
+    if (atomic_load(&running))
+        return EBUSY;
+
+    log_out = out;
+    atomic_store(&stopping, false);
+
+    /* Never inherit the SCHED_FIFO policy of a real-time caller */
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+    pthread_attr_setschedparam(&attr, &param);
+    rc = pthread_create(&writer_thread, &attr, writer, NULL);
+    pthread_attr_destroy(&attr);
+    if (rc != 0)
+        return rc;
+
+    atomic_store_explicit(&running, true, memory_order_release);
+    return 0;
+}
+
+void binlog_shutdown(void)
+{
+    uint64_t dropped;
+
+    if (!atomic_load(&running))
+        return;
+
+    atomic_store(&stopping, true);
+    pthread_join(writer_thread, NULL);
+    atomic_store_explicit(&running, false, memory_order_release);
+
+    drain();
+    dropped = binlog_dropped();
+    if (dropped)
+        fprintf(log_out, "\nbinlog: %lu records dropped\n", (unsigned long)dropped);
+    fflush(log_out);
+}
@@ -0,0 +1,119 @@
+/*
+ * File: binlog.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Deferred-formatting binary logger for real-time threads.
+ *
+ *		BINLOG(fmt, ...) does not format anything. It stores a pointer
+ *		to a static descriptor for the call site (format string and
+ *		argument types, fixed at compile time) plus the raw argument
+ *		values into a lock-free single-producer ring owned by the
+ *		calling thread. A background SCHED_OTHER thread drains every
+ *		ring, formats the records in timestamp order and writes them
+ *		out. A call never blocks: if the thread's ring is full the
+ *		record is dropped and counted.
+ *
+ *		Supported conversions are the printf integer, floating point,
+ *		%c, %s and %p conversions; '*' widths are not supported.
+ *		Strings are copied into the record, so the caller may free them
+ *		right after the call. The format string is still checked
+ *		against the arguments by the compiler.
+ *
+ *		If binlog_init() has not been called, BINLOG formats and prints
+ *		synchronously so the programs still work unchanged.
+ * Date: 16th October 2026
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define BINLOG_MAX_ARGS 8
+#define BINLOG_BUF_SIZE (64 * 1024)     /* per thread, power of two */
+#define BINLOG_MAX_STR  4096            /* longer strings are truncated */
+
+enum { BINLOG_INT, BINLOG_UINT, BINLOG_DBL, BINLOG_PTR, BINLOG_STR };
+
+typedef struct {
+    const char *fmt;
+    uint8_t nargs;
+    uint8_t types[BINLOG_MAX_ARGS];
+} binlog_fmt;
+
+typedef union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void *p;
+    const char *s;
+} binlog_arg;
+
+/* Start the background writer. Returns 0 or an errno value. */
+int binlog_init(FILE *out);
+
+/* Drain every ring, stop the background writer and flush 'out' */
+void binlog_shutdown(void);
+
+/* Optionally allocate the calling thread's ring up front, off the hot path */
+void binlog_thread_init(void);
+
+/* Records dropped so far because a ring was full */
+uint64_t binlog_dropped(void);
+
+void binlog_write(const binlog_fmt *fmt, const binlog_arg *args);
+
+static inline binlog_arg binlog_arg_int(int64_t v) { binlog_arg a; a.i = v; return a; }
+static inline binlog_arg binlog_arg_uint(uint64_t v) { binlog_arg a; a.u = v; return a; }
+static inline binlog_arg binlog_arg_dbl(double v) { binlog_arg a; a.d = v; return a; }
+static inline binlog_arg binlog_arg_ptr(const volatile void *v) { binlog_arg a; a.p = (const void *)v; return a; }
+static inline binlog_arg binlog_arg_str(const char *v) { binlog_arg a; a.s = v; return a; }
+
+#define BINLOG_TYPE(x) _Generic((x),                                        \
+    char: BINLOG_INT, signed char: BINLOG_INT, short: BINLOG_INT,           \
+    int: BINLOG_INT, long: BINLOG_INT, long long: BINLOG_INT,               \
+    _Bool: BINLOG_UINT, unsigned char: BINLOG_UINT,                         \
+    unsigned short: BINLOG_UINT, unsigned int: BINLOG_UINT,                 \
+    unsigned long: BINLOG_UINT, unsigned long long: BINLOG_UINT,            \
+    float: BINLOG_DBL, double: BINLOG_DBL,                                  \
+    char *: BINLOG_STR, const char *: BINLOG_STR,                           \
+    default: BINLOG_PTR)
+
+#define BINLOG_ARG(x) _Generic((x),                                         \
+    char: binlog_arg_int, signed char: binlog_arg_int, short: binlog_arg_int, \
+    int: binlog_arg_int, long: binlog_arg_int, long long: binlog_arg_int,   \
+    _Bool: binlog_arg_uint, unsigned char: binlog_arg_uint,                 \
+    unsigned short: binlog_arg_uint, unsigned int: binlog_arg_uint,         \
+    unsigned long: binlog_arg_uint, unsigned long long: binlog_arg_uint,    \
+    float: binlog_arg_dbl, double: binlog_arg_dbl,                          \
+    char *: binlog_arg_str, const char *: binlog_arg_str,                   \
+    default: binlog_arg_ptr)(x)
+
+#define BINLOG_NARGS(...) BINLOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define BINLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+#define BINLOG_MAP(m, ...) BINLOG_MAP_(BINLOG_NARGS(__VA_ARGS__), m, ##__VA_ARGS__)
+#define BINLOG_MAP_(n, m, ...) BINLOG_MAP__(n, m, ##__VA_ARGS__)
+#define BINLOG_MAP__(n, m, ...) BINLOG_MAP_##n(m, ##__VA_ARGS__)
+#define BINLOG_MAP_0(m)
+#define BINLOG_MAP_1(m, a) m(a),
+#define BINLOG_MAP_2(m, a, ...) m(a), BINLOG_MAP_1(m, __VA_ARGS__)
+#define BINLOG_MAP_3(m, a, ...) m(a), BINLOG_MAP_2(m, __VA_ARGS__)
+#define BINLOG_MAP_4(m, a, ...) m(a), BINLOG_MAP_3(m, __VA_ARGS__)
+#define BINLOG_MAP_5(m, a, ...) m(a), BINLOG_MAP_4(m, __VA_ARGS__)
+#define BINLOG_MAP_6(m, a, ...) m(a), BINLOG_MAP_5(m, __VA_ARGS__)
+#define BINLOG_MAP_7(m, a, ...) m(a), BINLOG_MAP_6(m, __VA_ARGS__)
+#define BINLOG_MAP_8(m, a, ...) m(a), BINLOG_MAP_7(m, __VA_ARGS__)
+
+#define BINLOG(format, ...) do {                                            \
+    static const binlog_fmt binlog_site_ = {                                \
+        format, BINLOG_NARGS(__VA_ARGS__),                                  \
+        { BINLOG_MAP(BINLOG_TYPE, ##__VA_ARGS__) } };                       \
+    const binlog_arg binlog_args_[BINLOG_MAX_ARGS + 1] = {                  \
+        BINLOG_MAP(BINLOG_ARG, ##__VA_ARGS__) };                            \
+    if (0)                                                                  \
+        printf(format, ##__VA_ARGS__);  /* format checking only */          \
+    binlog_write(&binlog_site_, binlog_args_);                              \
+} while (0)
+
+#endif /* BINLOG_H */
@@ -0,0 +1,94 @@
+/*
+ * File: hist.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Log-linear latency histogram, see hist.h.
+ * Date: 16th October 2026
+ */
+
+#include <string.h>
+
+#include "hist.h"
+
+#define LOAD(x) atomic_load_explicit(&(x), memory_order_relaxed)
+
+void hist_init(hist_t *h)
+{
+    memset(h, 0, sizeof(*h));
+    atomic_store(&h->min, UINT64_MAX);
+}
+
+void hist_merge(hist_t *dst, const hist_t *src)
+{
+    for (unsigned i = 0; i < HIST_BUCKETS; i++)
+        hist_bump(&dst->buckets[i], LOAD(src->buckets[i]));
+    hist_bump(&dst->sum, LOAD(src->sum));
+    if (LOAD(src->min) < LOAD(dst->min))
+        atomic_store(&dst->min, LOAD(src->min));
+    if (LOAD(src->max) > LOAD(dst->max))
+        atomic_store(&dst->max, LOAD(src->max));
+    hist_bump(&dst->count, LOAD(src->count));
+}
+
+static uint64_t bucket_upper(unsigned idx)
+{
+    unsigned exp, sub;
+
+    if (idx < HIST_SUB_COUNT)
+        return idx;
+    exp = idx / HIST_SUB_COUNT + HIST_SUB_BITS - 1;
+    sub = idx % HIST_SUB_COUNT;
+    return (((uint64_t)(HIST_SUB_COUNT + sub) + 1) << (exp - HIST_SUB_BITS)) - 1;
+}
+
+uint64_t hist_percentile(const hist_t *h, double p)
+{
+    uint64_t total = 0, target, seen = 0;
+
+    /* Sum the buckets rather than trusting count, which a live writer may be ahead of */
+    for (unsigned i = 0; i < HIST_BUCKETS; i++)
+        total += LOAD(h->buckets[i]);
+    if (total == 0)
+        return 0;
+
+    target = (uint64_t)(p / 100.0 * (double)total + 0.5);
+    if (target == 0)
+        target = 1;
+    if (target > total)
+        target = total;
+
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        seen += LOAD(h->buckets[i]);
+        if (seen >= target) {
+            uint64_t upper = bucket_upper(i), max = LOAD(h->max);
+            return upper < max ? upper : max;
+        }
+    }
+    return LOAD(h->max);
+}
+
+uint64_t hist_count(const hist_t *h)
+{
+    return atomic_load_explicit(&h->count, memory_order_acquire);
+}
+
+double hist_mean(const hist_t *h)
+{
+    uint64_t n = hist_count(h);
+
+    return n ? (double)LOAD(h->sum) / (double)n : 0.0;
+}
+
+void hist_print(FILE *out, const char *name, const hist_t *h)
+{
+    uint64_t n = hist_count(h);
+
+    if (n == 0) {
+        fprintf(out, "%-24s n=0\n", name);
+        return;
+    }
+    fprintf(out, "%-24s n=%-9lu min=%.3f avg=%.3f p50=%.3f p99=%.3f p99.9=%.3f max=%.3f us\n",
+            name, (unsigned long)n,
+            LOAD(h->min) / 1e3, hist_mean(h) / 1e3,
+            hist_percentile(h, 50.0) / 1e3, hist_percentile(h, 99.0) / 1e3,
+            hist_percentile(h, 99.9) / 1e3, LOAD(h->max) / 1e3);
+}
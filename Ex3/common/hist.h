@@ -0,0 +1,78 @@
+/*
+ * File: hist.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Log-linear latency histogram. Values below HIST_SUB_COUNT
+ *		get one bucket each; every power of two above that is split
+ *		into HIST_SUB_COUNT linear sub-buckets, so the relative error
+ *		of a reported percentile is bounded by 1/HIST_SUB_COUNT.
+ *
+ *		A histogram has a single writer. Buckets are updated with
+ *		relaxed atomic loads and stores, so another thread may print
+ *		or merge it at any time without taking a lock.
+ * Date: 16th October 2026
+ */
+
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define HIST_SUB_BITS  4
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS   ((64 - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t min;
+    _Atomic uint64_t max;
+    _Atomic uint64_t buckets[HIST_BUCKETS];
+} hist_t;
+
+static inline unsigned hist_bucket(uint64_t v)
+{
+    unsigned exp, sub;
+
+    if (v < HIST_SUB_COUNT)
+        return (unsigned)v;
+    exp = 63 - (unsigned)__builtin_clzll(v);
+    sub = (unsigned)(v >> (exp - HIST_SUB_BITS)) & (HIST_SUB_COUNT - 1);
+    return (exp - HIST_SUB_BITS + 1) * HIST_SUB_COUNT + sub;
+}
+
+/* Single-writer increment, readable concurrently from other threads */
+static inline void hist_bump(_Atomic uint64_t *ctr, uint64_t by)
+{
+    atomic_store_explicit(ctr, atomic_load_explicit(ctr, memory_order_relaxed) + by,
+                          memory_order_relaxed);
+}
+
+static inline void hist_record(hist_t *h, uint64_t v)
+{
+    hist_bump(&h->buckets[hist_bucket(v)], 1);
+    hist_bump(&h->sum, v);
+    if (v < atomic_load_explicit(&h->min, memory_order_relaxed))
+        atomic_store_explicit(&h->min, v, memory_order_relaxed);
+    if (v > atomic_load_explicit(&h->max, memory_order_relaxed))
+        atomic_store_explicit(&h->max, v, memory_order_relaxed);
+    atomic_store_explicit(&h->count, atomic_load_explicit(&h->count, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+void hist_init(hist_t *h);
+
+/* Add the samples of 'src' to 'dst'. 'dst' must not have a concurrent writer. */
+void hist_merge(hist_t *dst, const hist_t *src);
+
+/* Upper bound of the bucket holding the p-th percentile (0 < p <= 100) */
+uint64_t hist_percentile(const hist_t *h, double p);
+
+uint64_t hist_count(const hist_t *h);
+double hist_mean(const hist_t *h);
+
+/* One line: count, min, avg, p50, p99, p99.9 and max, in microseconds */
+void hist_print(FILE *out, const char *name, const hist_t *h);
+
+#endif /* HIST_H */
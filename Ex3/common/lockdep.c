@@ -0,0 +1,363 @@
+/*
+ * File: lockdep.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Runtime lock-order validator, see lockdep.h.
+ *
+ *		Classes are found by mutex address in an open-addressing hash
+ *		table that readers probe without a lock. The order graph is
+ *		kept twice as LOCKDEP_MAX_CLASSES x LOCKDEP_MAX_CLASSES bit
+ *		matrices: 'order' has every edge seen, 'blocking' only the
+ *		edges seen with an acquisition that can block. A new bit in
+ *		either matrix triggers a breadth-first search for a path back
+ *		from the new edge's target to its source. A path in 'blocking'
+ *		is a possible deadlock; a path only in 'order' is an inversion
+ *		that some trylock keeps from deadlocking.
+ *
+ *		A cycle is identified by its set of classes, so the same cycle
+ *		found again through another edge is not reported twice; it is
+ *		reported again only when it turns from an inversion into a
+ *		possible deadlock.
+ * Date: 16th October 2026
+ */
+
+#define LOCKDEP_IMPL
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "lockdep.h"
+
+#define WORDS          (LOCKDEP_MAX_CLASSES / 64)
+#define HASH_SIZE      (4 * LOCKDEP_MAX_CLASSES)   /* power of two */
+#define MAX_REPORTS    64
+#define NO_CLASS       0xffff
+
+typedef struct {
+    const char *name;
+    const void *addr;
+} lock_class;
+
+typedef struct {
+    uint16_t from, to;
+    const char *file;
+    int line;
+    pid_t tid;
+} lock_edge;
+
+typedef struct {
+    uint64_t members[WORDS];
+    bool deadlock;
+} cycle_report;
+
+static pthread_mutex_t graph_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct {
+    _Atomic(const void *) key;
+    uint16_t id;
+} hash[HASH_SIZE];
+
+static lock_class classes[LOCKDEP_MAX_CLASSES];
+static atomic_uint nclasses;
+static _Atomic uint64_t order[LOCKDEP_MAX_CLASSES][WORDS];
+static _Atomic uint64_t blocking[LOCKDEP_MAX_CLASSES][WORDS];
+
+static lock_edge edges[LOCKDEP_MAX_EDGES];
+static unsigned nedges;
+static cycle_report reports[MAX_REPORTS];
+static unsigned nreports;
+static _Atomic uint64_t cycles;
+static _Atomic uint64_t untracked;      /* acquisitions beyond the limits */
+
+static __thread uint16_t held[LOCKDEP_MAX_HELD];
+static __thread unsigned nheld;
+
+static unsigned hash_addr(const void *addr)
+{
+    uintptr_t a = (uintptr_t)addr;
+
+    a ^= a >> 17;
+    a *= 0x9e3779b97f4a7c15ull;
+    return (unsigned)(a >> 32) & (HASH_SIZE - 1);
+}
+
+/* Class of 'm', registering it on first use. NO_CLASS when the table is full. */
+static uint16_t class_of(pthread_mutex_t *m, const char *name)
+{
+    unsigned h = hash_addr(m);
+    uint16_t id = NO_CLASS;
+
+    for (unsigned i = 0; i < HASH_SIZE; i++) {
+        unsigned slot = (h + i) & (HASH_SIZE - 1);
+        const void *key = atomic_load_explicit(&hash[slot].key, memory_order_acquire);
+        if (key == m)
+            return hash[slot].id;
+        if (key == NULL)
+            break;
+    }
+
+    pthread_mutex_lock(&graph_lock);
+    for (unsigned i = 0; i < HASH_SIZE; i++) {
+        unsigned slot = (h + i) & (HASH_SIZE - 1);
+        const void *key = atomic_load_explicit(&hash[slot].key, memory_order_relaxed);
+        if (key == m) {
+            id = hash[slot].id;
+            break;
+        }
+        if (key == NULL) {
+            unsigned n = atomic_load_explicit(&nclasses, memory_order_relaxed);
+            if (n >= LOCKDEP_MAX_CLASSES)
+                break;
+            /* The macros pass "&name"; show just the name */
+            classes[n].name = name[0] == '&' ? name + 1 : name;
+            classes[n].addr = m;
+            hash[slot].id = (uint16_t)n;
+            atomic_store_explicit(&nclasses, n + 1, memory_order_relaxed);
+            atomic_store_explicit(&hash[slot].key, m, memory_order_release);
+            id = (uint16_t)n;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&graph_lock);
+    return id;
+}
+
+static bool test_bit(_Atomic uint64_t (*matrix)[WORDS], unsigned from, unsigned to)
+{
+    return atomic_load_explicit(&matrix[from][to / 64], memory_order_relaxed) & (1ull << (to % 64));
+}
+
+static void set_bit(_Atomic uint64_t (*matrix)[WORDS], unsigned from, unsigned to)
+{
+    atomic_fetch_or_explicit(&matrix[from][to / 64], 1ull << (to % 64), memory_order_relaxed);
+}
+
+/*
+ * Breadth-first search from 'start' to 'goal' in 'matrix'. On success the
+ * path goal <- ... <- start is left in 'parent'.
+ */
+static bool find_path(_Atomic uint64_t (*matrix)[WORDS], unsigned start, unsigned goal, uint16_t *parent)
+{
+    uint16_t queue[LOCKDEP_MAX_CLASSES];
+    uint64_t seen[WORDS] = { 0 };
+    unsigned head = 0, tail = 0, n = atomic_load_explicit(&nclasses, memory_order_relaxed);
+
+    queue[tail++] = (uint16_t)start;
+    seen[start / 64] |= 1ull << (start % 64);
+    while (head < tail) {
+        unsigned c = queue[head++];
+        if (c == goal)
+            return true;
+        for (unsigned w = 0; w < WORDS; w++) {
+            uint64_t next = atomic_load_explicit(&matrix[c][w], memory_order_relaxed) & ~seen[w];
+            while (next) {
+                unsigned bit = (unsigned)__builtin_ctzll(next), to = w * 64 + bit;
+                next &= next - 1;
+                if (to >= n)
+                    continue;
+                seen[w] |= 1ull << bit;
+                parent[to] = (uint16_t)c;
+                queue[tail++] = (uint16_t)to;
+            }
+        }
+    }
+    return false;
+}
+
+static const lock_edge *find_edge(unsigned from, unsigned to)
+{
+    for (unsigned i = 0; i < nedges; i++)
+        if (edges[i].from == from && edges[i].to == to)
+            return &edges[i];
+    return NULL;
+}
+
+static void print_edge(FILE *out, unsigned from, unsigned to)
+{
+    const lock_edge *e = find_edge(from, to);
+
+    fprintf(out, "lockdep:   %s -> %s", classes[from].name, classes[to].name);
+    if (e != NULL)
+        fprintf(out, "  first at %s:%d by thread %d%s", e->file, e->line, (int)e->tid,
+                test_bit(blocking, from, to) ? "" : " (trylock only)");
+    fputc('\n', out);
+}
+
+/* Called with graph_lock held after the edge from -> to gained a bit */
+static void check_cycle(unsigned from, unsigned to)
+{
+    uint16_t parent[LOCKDEP_MAX_CLASSES];
+    cycle_report rep = { { 0 }, false };
+    unsigned c;
+
+    if (test_bit(blocking, from, to) && find_path(blocking, to, from, parent))
+        rep.deadlock = true;
+    else if (!find_path(order, to, from, parent))
+        return;
+
+    for (c = from; ; c = parent[c]) {
+        rep.members[c / 64] |= 1ull << (c % 64);
+        if (c == to)
+            break;
+    }
+    for (unsigned i = 0; i < nreports; i++) {
+        if (memcmp(reports[i].members, rep.members, sizeof(rep.members)) == 0 &&
+            (reports[i].deadlock || !rep.deadlock)) {
+            return;
+        }
+    }
+    if (nreports < MAX_REPORTS)
+        reports[nreports++] = rep;
+    atomic_fetch_add(&cycles, 1);
+
+    fprintf(stderr, "\nlockdep: %s: %s -> %s closes a cycle\n",
+            rep.deadlock ? "possible deadlock" : "lock order inversion (a trylock prevents the deadlock)",
+            classes[from].name, classes[to].name);
+    print_edge(stderr, from, to);
+    for (c = from; c != to; c = parent[c])
+        print_edge(stderr, parent[c], c);
+    fflush(stderr);
+}
+
+static void add_edge(unsigned from, unsigned to, bool is_blocking, const char *file, int line)
+{
+    pthread_mutex_lock(&graph_lock);
+    if (!test_bit(order, from, to) && nedges < LOCKDEP_MAX_EDGES)
+        edges[nedges++] = (lock_edge){ (uint16_t)from, (uint16_t)to, file, line,
+                                       (pid_t)syscall(SYS_gettid) };
+    set_bit(order, from, to);
+    if (is_blocking)
+        set_bit(blocking, from, to);
+    check_cycle(from, to);
+    pthread_mutex_unlock(&graph_lock);
+}
+
+void lockdep_acquire(pthread_mutex_t *m, const char *name, const char *file, int line, int is_blocking)
+{
+    uint16_t c = class_of(m, name);
+
+    if (c == NO_CLASS || nheld >= LOCKDEP_MAX_HELD) {
+        atomic_fetch_add_explicit(&untracked, 1, memory_order_relaxed);
+        return;
+    }
+
+    /* Fast path: every edge already known with at least this strength */
+    for (unsigned i = 0; i < nheld; i++) {
+        unsigned h = held[i];
+        if (h == c)
+            continue;   /* recursive or relock of the same class */
+        if (!test_bit(order, h, c) || (is_blocking && !test_bit(blocking, h, c)))
+            add_edge(h, c, is_blocking, file, line);
+    }
+    held[nheld++] = c;
+}
+
+void lockdep_release(pthread_mutex_t *m)
+{
+    unsigned h = hash_addr(m);
+    uint16_t c = NO_CLASS;
+
+    for (unsigned i = 0; i < HASH_SIZE; i++) {
+        unsigned slot = (h + i) & (HASH_SIZE - 1);
+        const void *key = atomic_load_explicit(&hash[slot].key, memory_order_acquire);
+        if (key == m) {
+            c = hash[slot].id;
+            break;
+        }
+        if (key == NULL)
+            return;
+    }
+
+    /* Usually the innermost lock, but any order of release is allowed */
+    for (unsigned i = nheld; i-- > 0; ) {
+        if (held[i] == c) {
+            memmove(&held[i], &held[i + 1], (nheld - i - 1) * sizeof(held[0]));
+            nheld--;
+            return;
+        }
+    }
+}
+
+int lockdep_mutex_lock(pthread_mutex_t *m, const char *name, const char *file, int line)
+{
+    int rc;
+
+    /* Check before blocking, so a deadlock that does happen is reported first */
+    lockdep_acquire(m, name, file, line, 1);
+    rc = pthread_mutex_lock(m);
+    if (rc != 0)
+        lockdep_release(m);
+    return rc;
+}
+
+int lockdep_mutex_trylock(pthread_mutex_t *m, const char *name, const char *file, int line)
+{
+    int rc = pthread_mutex_trylock(m);
+
+    if (rc == 0)
+        lockdep_acquire(m, name, file, line, 0);
+    return rc;
+}
+
+int lockdep_mutex_timedlock(pthread_mutex_t *m, const struct timespec *abstime,
+                            const char *name, const char *file, int line)
+{
+    int rc;
+
+    lockdep_acquire(m, name, file, line, 1);
+    rc = pthread_mutex_timedlock(m, abstime);
+    if (rc != 0)
+        lockdep_release(m);
+    return rc;
+}
+
+int lockdep_mutex_unlock(pthread_mutex_t *m)
+{
+    lockdep_release(m);
+    return pthread_mutex_unlock(m);
+}
+
+uint64_t lockdep_cycles(void)
+{
+    return atomic_load(&cycles);
+}
+
+void lockdep_set_name(pthread_mutex_t *m, const char *name)
+{
+    uint16_t c = class_of(m, name);
+
+    if (c == NO_CLASS)
+        return;
+    pthread_mutex_lock(&graph_lock);
+    classes[c].name = name;
+    pthread_mutex_unlock(&graph_lock);
+}
+
+void lockdep_reset(void)
+{
+    pthread_mutex_lock(&graph_lock);
+    for (unsigned c = 0; c < LOCKDEP_MAX_CLASSES; c++) {
+        for (unsigned w = 0; w < WORDS; w++) {
+            atomic_store_explicit(&order[c][w], 0, memory_order_relaxed);
+            atomic_store_explicit(&blocking[c][w], 0, memory_order_relaxed);
+        }
+    }
+    nedges = 0;
+    nreports = 0;
+    atomic_store(&cycles, 0);
+    atomic_store(&untracked, 0);
+    pthread_mutex_unlock(&graph_lock);
+}
+
+void lockdep_report(FILE *out)
+{
+    pthread_mutex_lock(&graph_lock);
+    fprintf(out, "lockdep: %u lock classes, %u order edges, %lu cycles reported, %lu acquisitions not tracked\n",
+            atomic_load(&nclasses), nedges, (unsigned long)atomic_load(&cycles),
+            (unsigned long)atomic_load(&untracked));
+    for (unsigned i = 0; i < nedges; i++)
+        print_edge(out, edges[i].from, edges[i].to);
+    pthread_mutex_unlock(&graph_lock);
+}
@@ -0,0 +1,85 @@
+/*
+ * File: lockdep.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Runtime lock-order validator for pthread mutexes, in the
+ *		spirit of the Linux kernel's lockdep.
+ *
+ *		Building with -DLOCKDEP and including this header after
+ *		<pthread.h> turns pthread_mutex_lock, _trylock, _timedlock and
+ *		_unlock into instrumented calls. Every mutex is a lock class,
+ *		named after the expression passed at its first acquisition
+ *		(e.g. "rsrcA"). Mutexes reached through an array or a pointer
+ *		would all share a name like "m", so lockdep_set_name() names
+ *		them explicitly (e.g. "rsrc[3]"). Each thread keeps the stack of classes it
+ *		holds; acquiring class C while holding H records the edge
+ *		H -> C in a global order graph shared by all threads.
+ *
+ *		The first time an edge closes a cycle, e.g. A -> B seen in one
+ *		thread and B -> A in another, the cycle is reported on stderr
+ *		with the file and line where each edge was first seen, even if
+ *		the run never actually deadlocks. Each cycle is reported once.
+ *		A trylock cannot block, so an edge that has only been seen with
+ *		trylock is reported as an order inversion rather than as a
+ *		possible deadlock; a timedlock can block and counts fully.
+ *
+ *		The graph is a bit matrix, so the common case (an edge that is
+ *		already known) costs one relaxed load per held lock and no
+ *		lock. Only a new edge takes the validator's own mutex and runs
+ *		the cycle search.
+ *
+ *		Without -DLOCKDEP nothing is remapped and the calls below are
+ *		unused. With -DMUTEX_PROF too, mutex_prof.h does the remapping
+ *		and calls the validator itself.
+ * Date: 16th October 2026
+ */
+
+#ifndef LOCKDEP_H
+#define LOCKDEP_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define LOCKDEP_MAX_CLASSES 256
+#define LOCKDEP_MAX_HELD    16      /* per thread; deeper nesting is not tracked */
+#define LOCKDEP_MAX_EDGES   1024    /* edges remembered with their first site */
+
+int lockdep_mutex_lock(pthread_mutex_t *m, const char *name, const char *file, int line);
+int lockdep_mutex_trylock(pthread_mutex_t *m, const char *name, const char *file, int line);
+int lockdep_mutex_timedlock(pthread_mutex_t *m, const struct timespec *abstime,
+                            const char *name, const char *file, int line);
+int lockdep_mutex_unlock(pthread_mutex_t *m);
+
+/*
+ * Record an acquisition or release without locking anything, for layers
+ * that wrap the mutex calls themselves. 'blocking' is false for trylock.
+ */
+void lockdep_acquire(pthread_mutex_t *m, const char *name, const char *file, int line, int blocking);
+void lockdep_release(pthread_mutex_t *m);
+
+/*
+ * Name the class of 'm' in reports instead of the expression of its
+ * first acquisition. 'name' must stay valid; call it before the mutex
+ * is shared.
+ */
+void lockdep_set_name(pthread_mutex_t *m, const char *name);
+
+/* Cycles reported so far */
+uint64_t lockdep_cycles(void);
+
+/* Classes, edges and cycles seen so far */
+void lockdep_report(FILE *out);
+
+/* Forget every edge and cycle; classes keep their names. Only while no thread holds a tracked mutex. */
+void lockdep_reset(void);
+
+#if defined(LOCKDEP) && !defined(LOCKDEP_IMPL) && !defined(MUTEX_PROF_IMPL) && \
+    !(defined(MUTEX_PROF) && defined(MUTEX_PROF_H))
+#define pthread_mutex_lock(m)         lockdep_mutex_lock((m), #m, __FILE__, __LINE__)
+#define pthread_mutex_trylock(m)      lockdep_mutex_trylock((m), #m, __FILE__, __LINE__)
+#define pthread_mutex_timedlock(m, t) lockdep_mutex_timedlock((m), (t), #m, __FILE__, __LINE__)
+#define pthread_mutex_unlock(m)       lockdep_mutex_unlock(m)
+#endif
+
+#endif /* LOCKDEP_H */
@@ -0,0 +1,280 @@
+/*
+ * File: mutex_prof.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Per-mutex contention profiler, see mutex_prof.h.
+ *
+ *		Mutexes are found by address in an open-addressing table that
+ *		is probed without a lock, as in lockdep.c. Every lock first
+ *		tries pthread_mutex_trylock(); only when that fails is the
+ *		acquisition contended and its wait timed.
+ * Date: 16th October 2026
+ */
+
+#define MUTEX_PROF_IMPL
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "hist.h"
+#include "lockdep.h"
+#include "mutex_prof.h"
+#include "rt_time.h"
+
+#define HASH_SIZE (4 * MUTEX_PROF_MAX)     /* power of two */
+
+typedef struct {
+    const char *name;
+    _Atomic uint64_t acquisitions;      /* written by the owner */
+    _Atomic uint64_t contended;         /* written by the owner */
+    _Atomic uint64_t trylock_busy;
+    _Atomic uint64_t timeouts;
+    atomic_int owner;                   /* thread id, 0 when free */
+    uint64_t acquired_ns;
+    hist_t wait;                        /* contended acquisitions only */
+    hist_t hold;
+} prof_entry;
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct {
+    _Atomic(const void *) key;
+    prof_entry *entry;
+} hash[HASH_SIZE];
+
+static prof_entry entries[MUTEX_PROF_MAX];
+static atomic_uint nentries;
+static _Atomic uint64_t unprofiled;     /* acquisitions of mutexes beyond the table */
+
+static __thread int tid;
+
+static int self(void)
+{
+    if (tid == 0)
+        tid = (int)syscall(SYS_gettid);
+    return tid;
+}
+
+static unsigned hash_addr(const void *addr)
+{
+    uintptr_t a = (uintptr_t)addr;
+
+    a ^= a >> 17;
+    a *= 0x9e3779b97f4a7c15ull;
+    return (unsigned)(a >> 32) & (HASH_SIZE - 1);
+}
+
+/* Entry of 'm', registering it under 'name' on first use. NULL when the table is full. */
+static prof_entry *entry_of(pthread_mutex_t *m, const char *name)
+{
+    unsigned h = hash_addr(m);
+    prof_entry *e = NULL;
+
+    for (unsigned i = 0; i < HASH_SIZE; i++) {
+        unsigned slot = (h + i) & (HASH_SIZE - 1);
+        const void *key = atomic_load_explicit(&hash[slot].key, memory_order_acquire);
+        if (key == m)
+            return hash[slot].entry;
+        if (key == NULL)
+            break;
+    }
+    if (name == NULL)
+        return NULL;
+
+    pthread_mutex_lock(&table_lock);
+    for (unsigned i = 0; i < HASH_SIZE; i++) {
+        unsigned slot = (h + i) & (HASH_SIZE - 1);
+        const void *key = atomic_load_explicit(&hash[slot].key, memory_order_relaxed);
+        if (key == m) {
+            e = hash[slot].entry;
+            break;
+        }
+        if (key == NULL) {
+            unsigned n = atomic_load_explicit(&nentries, memory_order_relaxed);
+            if (n >= MUTEX_PROF_MAX)
+                break;
+            e = &entries[n];
+            e->name = name[0] == '&' ? name + 1 : name;
+            hist_init(&e->wait);
+            hist_init(&e->hold);
+            hash[slot].entry = e;
+            atomic_store_explicit(&nentries, n + 1, memory_order_release);
+            atomic_store_explicit(&hash[slot].key, m, memory_order_release);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&table_lock);
+    return e;
+}
+
+/* Called right after taking the mutex; 'wait_start_ns' is only used when contended */
+static void acquired(prof_entry *e, bool contended, uint64_t wait_start_ns)
+{
+    uint64_t now = now_ns(CLOCK_MONOTONIC);
+
+    if (e == NULL) {
+        atomic_fetch_add_explicit(&unprofiled, 1, memory_order_relaxed);
+        return;
+    }
+    hist_bump(&e->acquisitions, 1);
+    if (contended) {
+        hist_bump(&e->contended, 1);
+        hist_record(&e->wait, now - wait_start_ns);
+    }
+    e->acquired_ns = now;
+    atomic_store_explicit(&e->owner, self(), memory_order_relaxed);
+}
+
+/* Called right before letting the mutex go */
+static void released(prof_entry *e)
+{
+    if (e == NULL || atomic_load_explicit(&e->owner, memory_order_relaxed) != self())
+        return;
+    hist_record(&e->hold, now_ns(CLOCK_MONOTONIC) - e->acquired_ns);
+    atomic_store_explicit(&e->owner, 0, memory_order_relaxed);
+}
+
+int mutex_prof_lock(pthread_mutex_t *m, const char *name, const char *file, int line)
+{
+    prof_entry *e = entry_of(m, name);
+    uint64_t start = 0;
+    int rc;
+
+#ifdef LOCKDEP
+    lockdep_acquire(m, name, file, line, 1);
+#else
+    (void)file;
+    (void)line;
+#endif
+    if ((rc = pthread_mutex_trylock(m)) == EBUSY) {
+        start = now_ns(CLOCK_MONOTONIC);
+        rc = pthread_mutex_lock(m);
+    }
+    if (rc != 0) {
+#ifdef LOCKDEP
+        lockdep_release(m);
+#endif
+        return rc;
+    }
+    acquired(e, start != 0, start);
+    return 0;
+}
+
+int mutex_prof_trylock(pthread_mutex_t *m, const char *name, const char *file, int line)
+{
+    prof_entry *e = entry_of(m, name);
+    int rc = pthread_mutex_trylock(m);
+
+    if (rc == 0) {
+#ifdef LOCKDEP
+        lockdep_acquire(m, name, file, line, 0);
+#else
+        (void)file;
+        (void)line;
+#endif
+        acquired(e, false, 0);
+    } else if (rc == EBUSY && e != NULL) {
+        atomic_fetch_add_explicit(&e->trylock_busy, 1, memory_order_relaxed);
+    }
+    return rc;
+}
+
+int mutex_prof_timedlock(pthread_mutex_t *m, const struct timespec *abstime,
+                         const char *name, const char *file, int line)
+{
+    prof_entry *e = entry_of(m, name);
+    uint64_t start = 0;
+    int rc;
+
+#ifdef LOCKDEP
+    lockdep_acquire(m, name, file, line, 1);
+#else
+    (void)file;
+    (void)line;
+#endif
+    if ((rc = pthread_mutex_trylock(m)) == EBUSY) {
+        start = now_ns(CLOCK_MONOTONIC);
+        rc = pthread_mutex_timedlock(m, abstime);
+    }
+    if (rc != 0) {
+#ifdef LOCKDEP
+        lockdep_release(m);
+#endif
+        if (rc == ETIMEDOUT && e != NULL)
+            atomic_fetch_add_explicit(&e->timeouts, 1, memory_order_relaxed);
+        return rc;
+    }
+    acquired(e, start != 0, start);
+    return 0;
+}
+
+int mutex_prof_unlock(pthread_mutex_t *m)
+{
+    released(entry_of(m, NULL));
+#ifdef LOCKDEP
+    lockdep_release(m);
+#endif
+    return pthread_mutex_unlock(m);
+}
+
+int mutex_prof_cond_wait(pthread_cond_t *c, pthread_mutex_t *m, const char *name)
+{
+    prof_entry *e = entry_of(m, name);
+    int rc;
+
+    released(e);
+    rc = pthread_cond_wait(c, m);
+    acquired(e, false, 0);
+    return rc;
+}
+
+int mutex_prof_cond_timedwait(pthread_cond_t *c, pthread_mutex_t *m, const struct timespec *abstime,
+                              const char *name)
+{
+    prof_entry *e = entry_of(m, name);
+    int rc;
+
+    released(e);
+    rc = pthread_cond_timedwait(c, m, abstime);
+    acquired(e, false, 0);     /* the mutex is held again even on ETIMEDOUT */
+    return rc;
+}
+
+void mutex_prof_set_name(pthread_mutex_t *m, const char *name)
+{
+    prof_entry *e = entry_of(m, name);
+
+    if (e != NULL)
+        e->name = name;
+#ifdef LOCKDEP
+    lockdep_set_name(m, name);
+#endif
+}
+
+void mutex_prof_report(FILE *out)
+{
+    unsigned n = atomic_load_explicit(&nentries, memory_order_acquire);
+
+    fprintf(out, "mutex_prof: %u mutexes, %lu acquisitions not profiled\n",
+            n, (unsigned long)atomic_load(&unprofiled));
+    for (unsigned i = 0; i < n; i++) {
+        prof_entry *e = &entries[i];
+        uint64_t acq = atomic_load(&e->acquisitions), cont = atomic_load(&e->contended);
+        int owner = atomic_load(&e->owner);
+
+        fprintf(out, "mutex_prof: %s: %lu acquisitions, %lu contended (%.1f%%), "
+                "%lu trylock busy, %lu timeouts, ",
+                e->name, (unsigned long)acq, (unsigned long)cont, acq ? 100.0 * cont / acq : 0.0,
+                (unsigned long)atomic_load(&e->trylock_busy), (unsigned long)atomic_load(&e->timeouts));
+        if (owner)
+            fprintf(out, "owned by thread %d\n", owner);
+        else
+            fprintf(out, "free\n");
+        fprintf(out, "  ");
+        hist_print(out, "wait (contended)", &e->wait);
+        fprintf(out, "  ");
+        hist_print(out, "hold", &e->hold);
+    }
+}
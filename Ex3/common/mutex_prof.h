@@ -0,0 +1,73 @@
+/*
+ * File: mutex_prof.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Per-mutex contention profiler for pthread mutexes.
+ *
+ *		Building with -DMUTEX_PROF and including this header after
+ *		<pthread.h> turns pthread_mutex_lock, _trylock, _timedlock,
+ *		_unlock and pthread_cond_wait/_timedwait into profiled calls.
+ *		Each mutex is named after the expression passed at its first
+ *		acquisition (e.g. "rsrcA"), or by mutex_prof_set_name() when
+ *		that expression would not tell it apart (e.g. "m" for every
+ *		mutex reached through a pointer), and gets:
+ *		  - acquisitions, and how many of them were contended (the
+ *		    mutex was busy and the caller had to wait)
+ *		  - trylock calls that found it busy, timedlocks that timed out
+ *		  - a histogram of the wait of contended acquisitions
+ *		  - a histogram of the hold time, lock to unlock
+ *		  - the thread that owns it right now
+ *
+ *		Counters and histograms of a mutex are updated by its owner
+ *		while it holds the mutex, so the mutex itself serializes them
+ *		and an uncontended lock costs a trylock and one clock read.
+ *		A condition wait ends the hold; taking the mutex back counts
+ *		as an acquisition but its wait is the wait for the signal, so
+ *		it is not recorded as a mutex wait.
+ *
+ *		With -DLOCKDEP as well, the profiled calls also feed the
+ *		lock-order validator (lockdep.h), whose own remapping is then
+ *		turned off.
+ *
+ *		Without -DMUTEX_PROF nothing is remapped.
+ * Date: 16th October 2026
+ */
+
+#ifndef MUTEX_PROF_H
+#define MUTEX_PROF_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define MUTEX_PROF_MAX 32       /* profiled mutexes; more are not profiled */
+
+int mutex_prof_lock(pthread_mutex_t *m, const char *name, const char *file, int line);
+int mutex_prof_trylock(pthread_mutex_t *m, const char *name, const char *file, int line);
+int mutex_prof_timedlock(pthread_mutex_t *m, const struct timespec *abstime,
+                         const char *name, const char *file, int line);
+int mutex_prof_unlock(pthread_mutex_t *m);
+int mutex_prof_cond_wait(pthread_cond_t *c, pthread_mutex_t *m, const char *name);
+int mutex_prof_cond_timedwait(pthread_cond_t *c, pthread_mutex_t *m, const struct timespec *abstime,
+                              const char *name);
+
+/* Name 'm' in the report, and for lockdep with -DLOCKDEP. 'name' must stay valid; call it before 'm' is shared. */
+void mutex_prof_set_name(pthread_mutex_t *m, const char *name);
+
+/* Counters, owner and wait/hold histograms of every mutex seen so far */
+void mutex_prof_report(FILE *out);
+
+#if defined(MUTEX_PROF) && !defined(MUTEX_PROF_IMPL)
+/* Replaces lockdep.h's remapping when that was included first */
+#undef pthread_mutex_lock
+#undef pthread_mutex_trylock
+#undef pthread_mutex_timedlock
+#undef pthread_mutex_unlock
+#define pthread_mutex_lock(m)            mutex_prof_lock((m), #m, __FILE__, __LINE__)
+#define pthread_mutex_trylock(m)         mutex_prof_trylock((m), #m, __FILE__, __LINE__)
+#define pthread_mutex_timedlock(m, t)    mutex_prof_timedlock((m), (t), #m, __FILE__, __LINE__)
+#define pthread_mutex_unlock(m)          mutex_prof_unlock(m)
+#define pthread_cond_wait(c, m)          mutex_prof_cond_wait((c), (m), #m)
+#define pthread_cond_timedwait(c, m, t)  mutex_prof_cond_timedwait((c), (m), (t), #m)
+#endif
+
+#endif /* MUTEX_PROF_H */
@@ -0,0 +1,180 @@
+/*
+ * File: nav_batch.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Structure-of-arrays nav_state kernel, see nav_batch.h.
+ *
+ *		sin/cos are evaluated in three steps that contain no branches
+ *		or library calls, so GCC vectorizes the loops:
+ *		1. Reduce the argument modulo 2*pi. The multiple k * 2*pi is
+ *		   formed exactly with Dekker's two-product against a
+ *		   three-part 2*pi. A second pass cleans up when k itself is
+ *		   too large to be the exact nearest integer.
+ *		2. Reduce by pi/2 and keep the quadrant.
+ *		3. Evaluate the fdlibm kernel polynomials on [-pi/4, pi/4].
+ *
+ *		Must be built with -ffp-contract=off: fused multiply-adds
+ *		would break the exact two-product. -fno-trapping-math lets GCC
+ *		turn the selects into blends and vectorize the trig loop.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nav_batch.h"
+#include "nav_state.h"
+
+#define NAV_BATCH_ALIGN 64
+#define NAV_BATCH_COLUMNS 7
+
+/* 2*pi split into three doubles */
+static const double TWO_PI_1 = 6.28318530717958623200e+00;
+static const double TWO_PI_2 = 2.44929359829470635445e-16;
+static const double TWO_PI_3 = -5.98953961943667900000e-33;
+static const double INV_TWO_PI = 1.59154943091895345608e-01;
+
+/* pi/2 split as in fdlibm: q * PIO2_1 and q * PIO2_2 are exact for small q */
+static const double PIO2_1 = 1.57079632673412561417e+00;
+static const double PIO2_2 = 6.07710050630396597660e-11;
+static const double PIO2_3 = 2.02226624879595063154e-21;
+static const double TWO_OVER_PI = 6.36619772367581382433e-01;
+
+/* fdlibm __kernel_sin / __kernel_cos coefficients */
+static const double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+                    S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+                    S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+static const double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+                    C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+                    C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+
+/* Round to nearest integer without a libm call. Values >= 2^51 are already integers. */
+static inline double round_int(double y)
+{
+    const double magic = 6755399441055744.0;   /* 1.5 * 2^52 */
+    double r = (y + magic) - magic;
+
+    return fabs(y) < 0x1p51 ? r : y;
+}
+
+/* Veltkamp split of a into hi + lo with at most 26 significant bits each */
+static inline void split(double a, double *hi, double *lo)
+{
+    double c = 134217729.0 * a;                 /* 2^27 + 1 */
+
+    *hi = c - (c - a);
+    *lo = a - *hi;
+}
+
+/* Dekker: a * b == *p + *e exactly */
+static inline void two_prod(double a, double b, double *p, double *e)
+{
+    double ah, al, bh, bl;
+
+    *p = a * b;
+    split(a, &ah, &al);
+    split(b, &bh, &bl);
+    *e = ((ah * bh - *p) + ah * bl + al * bh) + al * bl;
+}
+
+static inline double reduce_two_pi_once(double x)
+{
+    double k = round_int(x * INV_TWO_PI);
+    double p, e, r;
+
+    two_prod(k, TWO_PI_1, &p, &e);
+    r = (x - p) - e;                            /* x - p is exact (Sterbenz) */
+    two_prod(k, TWO_PI_2, &p, &e);
+    r = (r - p) - e;
+    return r - k * TWO_PI_3;
+}
+
+/* x modulo 2*pi into roughly [-pi, pi] */
+static inline double reduce_two_pi(double x)
+{
+    return reduce_two_pi_once(reduce_two_pi_once(x));
+}
+
+/* sin and cos of r where |r| is at most a little over pi */
+static inline void sincos_reduced(double r, double *s, double *c)
+{
+    double q = round_int(r * TWO_OVER_PI);
+    double y = ((r - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+    double z = y * y;
+    double ps = y + y * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    double pc = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    int quadrant = (int)q & 3;                  /* two's complement: -1 -> 3, -2 -> 2 */
+    int swap = quadrant & 1;
+    double sign_s = 1.0 - (double)(quadrant & 2);
+    double sign_c = 1.0 - (double)((quadrant + 1) & 2);
+
+    *s = sign_s * (swap ? pc : ps);
+    *c = sign_c * (swap ? ps : pc);
+}
+
+int nav_batch_init(nav_batch *b, size_t capacity)
+{
+    size_t stride = (capacity + 7) & ~(size_t)7;    /* keep every column 64-byte aligned */
+    double *block;
+
+    if (stride == 0)
+        stride = 8;
+    if (stride > SIZE_MAX / sizeof(double) / NAV_BATCH_COLUMNS) {
+        errno = ENOMEM;
+        return -1;
+    }
+    block = aligned_alloc(NAV_BATCH_ALIGN, stride * sizeof(double) * NAV_BATCH_COLUMNS);
+    if (block == NULL)
+        return -1;
+
+    b->count = 0;
+    b->capacity = capacity;
+    b->Time = block;
+    b->Latitude = block + stride;
+    b->Longitude = block + 2 * stride;
+    b->Altitude = block + 3 * stride;
+    b->Roll = block + 4 * stride;
+    b->Pitch = block + 5 * stride;
+    b->Yaw = block + 6 * stride;
+    return 0;
+}
+
+void nav_batch_destroy(nav_batch *b)
+{
+    free(b->Time);
+    b->Time = NULL;
+    b->count = b->capacity = 0;
+}
+
+void nav_batch_compute(nav_batch *b, const struct timespec *ts, size_t n)
+{
+    double *restrict t = b->Time;
+    double *restrict lat = b->Latitude, *restrict lon = b->Longitude, *restrict alt = b->Altitude;
+    double *restrict roll = b->Roll, *restrict pitch = b->Pitch, *restrict yaw = b->Yaw;
+
+    if (n > b->capacity)
+        n = b->capacity;
+
+    for (size_t i = 0; i < n; i++)
+        t[i] = nav_state_seconds(&ts[i]);
+
+    for (size_t i = 0; i < n; i++) {
+        lat[i] = 0.01 * t[i];
+        lon[i] = 0.2 * t[i];
+        alt[i] = 0.25 * t[i];
+    }
+
+    /* Same expressions as nav_state_compute, so the arguments round identically */
+    for (size_t i = 0; i < n; i++) {
+        double s, c, unused;
+
+        sincos_reduced(reduce_two_pi(2 * PI * t[i]), &s, &c);
+        roll[i] = s;
+        yaw[i] = c;
+        sincos_reduced(reduce_two_pi(2 * PI * t[i] * t[i]), &unused, &c);
+        pitch[i] = c;
+    }
+
+    b->count = n;
+}
@@ -0,0 +1,140 @@
+/*
+ * File: nav_ring.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Lock-free single-producer/single-consumer ring of nav_state
+ *		records. The update thread pushes every sample it computes and
+ *		the read thread drains everything published since its last
+ *		read in one batch, so a slow reader no longer loses samples.
+ *
+ *		head is only written by the consumer and tail only by the
+ *		producer. The producer keeps a private copy of head and only
+ *		reloads it when the ring looks full.
+ *		When the ring is full the producer drops the new sample and
+ *		counts it instead of blocking. The slots are allocated at
+ *		startup; nav_ring_capacity() sizes them so that a reader that
+ *		drains once per period keeps up with the update rate.
+ * Date: 16th October 2026
+ */
+
+#ifndef NAV_RING_H
+#define NAV_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nav_state.h"
+
+#define NAV_RING_MIN_SIZE 64
+#define NAV_RING_MAX_SIZE ((size_t)1 << 20)   /* 1M records; also used when unthrottled */
+#define NAV_RING_BATCH 64                     /* Records a reader copies out per drain call */
+#define NAV_CACHELINE 64
+
+typedef struct {
+    /* Producer side */
+    _Alignas(NAV_CACHELINE) atomic_size_t tail;
+    size_t head_cache;
+    atomic_size_t dropped;              /* Read by the consumer for reporting */
+
+    /* Consumer side */
+    _Alignas(NAV_CACHELINE) atomic_size_t head;
+
+    /* Fixed at init */
+    _Alignas(NAV_CACHELINE) size_t size;      /* Power of two */
+    size_t mask;
+    nav_state *slots;
+} nav_ring;
+
+/*
+ * Slots needed to hold every sample produced at 'update_hz' between two
+ * drains 'read_period_ns' apart, with 2x headroom for a late reader.
+ * 0 Hz (unthrottled) gets NAV_RING_MAX_SIZE.
+ */
+static inline size_t nav_ring_capacity(double update_hz, uint64_t read_period_ns)
+{
+    double want = 2.0 * update_hz * ((double)read_period_ns / 1e9);
+    size_t size = NAV_RING_MIN_SIZE;
+
+    if (update_hz <= 0.0 || want >= (double)NAV_RING_MAX_SIZE)
+        return NAV_RING_MAX_SIZE;
+    while ((double)size < want)
+        size <<= 1;
+    return size;
+}
+
+/* 'size' is rounded up to a power of two. Returns -1 if out of memory. */
+static inline int nav_ring_init(nav_ring *ring, size_t size)
+{
+    size_t pow2 = 1;
+
+    while (pow2 < size)
+        pow2 <<= 1;
+    memset(ring, 0, sizeof(*ring));
+    ring->slots = calloc(pow2, sizeof(*ring->slots));
+    if (ring->slots == NULL)
+        return -1;
+    ring->size = pow2;
+    ring->mask = pow2 - 1;
+    return 0;
+}
+
+static inline void nav_ring_destroy(nav_ring *ring)
+{
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/* Producer: append one record. Returns false (and counts a drop) when full. */
+static inline bool nav_ring_push(nav_ring *ring, const nav_state *src)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail - ring->head_cache == ring->size) {
+        ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->head_cache == ring->size) {
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            return false;
+        }
+    }
+    ring->slots[tail & ring->mask] = *src;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+/* Consumer: copy up to 'max' pending records into 'out', oldest first. */
+static inline size_t nav_ring_drain(nav_ring *ring, nav_state *out, size_t max)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t n = atomic_load_explicit(&ring->tail, memory_order_acquire) - head;
+
+    if (n > max)
+        n = max;
+    for (size_t i = 0; i < n; i++)
+        out[i] = ring->slots[(head + i) & ring->mask];
+    atomic_store_explicit(&ring->head, head + n, memory_order_release);
+    return n;
+}
+
+/* Records pushed but not yet drained; safe to call from the consumer */
+static inline size_t nav_ring_pending(nav_ring *ring)
+{
+    return atomic_load_explicit(&ring->tail, memory_order_acquire) -
+           atomic_load_explicit(&ring->head, memory_order_relaxed);
+}
+
+/* Total number of records pushed so far; safe to call from any thread */
+static inline size_t nav_ring_published(nav_ring *ring)
+{
+    return atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/* Number of records dropped on a full ring so far; safe to call from any thread */
+static inline size_t nav_ring_dropped(nav_ring *ring)
+{
+    return atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+}
+
+#endif /* NAV_RING_H */
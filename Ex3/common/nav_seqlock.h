@@ -0,0 +1,102 @@
+/*
+ * File: nav_seqlock.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Sequence-lock publication of a nav_state. A single writer
+ *		publishes without ever blocking; readers copy a snapshot and
+ *		retry if the writer was active during the copy.
+ *
+ *		The sequence counter is odd while a write is in progress.
+ *		A reader samples it before and after copying the record and
+ *		only accepts the copy when both samples are equal and even.
+ *
+ *		Readers spin while a write is in flight, so a reader must not
+ *		run at a higher SCHED_FIFO priority than the writer on the same
+ *		core. A reader in another process uses nav_seqlock_try_read(),
+ *		which gives up instead of spinning forever on a writer that was
+ *		killed in the middle of a write.
+ * Date: 16th October 2026
+ */
+
+#ifndef NAV_SEQLOCK_H
+#define NAV_SEQLOCK_H
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "nav_state.h"
+
+typedef struct {
+    atomic_uint seq;
+    nav_state state;
+} nav_seqlock;
+
+#define NAV_SEQLOCK_INITIALIZER { 0, { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, { 0, 0 } } }
+
+/* Publish a new record. Must only be called from one thread at a time. */
+static inline void nav_seqlock_write(nav_seqlock *sl, const nav_state *src)
+{
+    unsigned seq = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&sl->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&sl->state, src, sizeof(*src));
+    atomic_store_explicit(&sl->seq, seq + 2, memory_order_release);
+}
+
+/*
+ * Copy a consistent snapshot into 'dst'. Returns the number of retries
+ * needed, which is zero unless the read raced with the writer.
+ */
+static inline unsigned nav_seqlock_read(nav_seqlock *sl, nav_state *dst)
+{
+    unsigned retries = 0;
+    unsigned start, end;
+
+    for (;;) {
+        start = atomic_load_explicit(&sl->seq, memory_order_acquire);
+        if (start & 1) {
+            retries++;
+            sched_yield();
+            continue;
+        }
+        memcpy(dst, &sl->state, sizeof(*dst));
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+        if (start == end)
+            return retries;
+        retries++;
+    }
+}
+
+/*
+ * Like nav_seqlock_read(), but gives up after 'max_retries' retries.
+ * Returns the retry count, or -1 if it gave up; 'dst' is then undefined.
+ */
+static inline int nav_seqlock_try_read(nav_seqlock *sl, nav_state *dst, unsigned max_retries)
+{
+    unsigned retries = 0;
+    unsigned start, end;
+
+    for (; retries <= max_retries; retries++) {
+        start = atomic_load_explicit(&sl->seq, memory_order_acquire);
+        if (start & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy(dst, &sl->state, sizeof(*dst));
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+        if (start == end)
+            return (int)retries;
+    }
+    return -1;
+}
+
+/* Number of completed publications so far */
+static inline unsigned nav_seqlock_version(nav_seqlock *sl)
+{
+    return atomic_load_explicit(&sl->seq, memory_order_acquire) >> 1;
+}
+
+#endif /* NAV_SEQLOCK_H */
@@ -0,0 +1,88 @@
+/*
+ * File: nav_shm.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Shared memory nav_state segment, see nav_shm.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nav_shm.h"
+
+nav_shm *nav_shm_create(const char *name, const nav_state *initial)
+{
+    nav_shm *shm;
+    int fd;
+
+    fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, sizeof(nav_shm)) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+
+    shm = mmap(NULL, sizeof(nav_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED)
+        return NULL;
+
+    /* Invalidate first so attachers wait while the segment is rebuilt */
+    atomic_store_explicit(&shm->magic, 0, memory_order_relaxed);
+    shm->layout = NAV_SHM_LAYOUT;
+    shm->size = sizeof(nav_shm);
+    shm->writer_pid = getpid();
+    atomic_store_explicit(&shm->pub.seq, 0, memory_order_relaxed);
+    nav_seqlock_write(&shm->pub, initial);
+    atomic_store_explicit(&shm->magic, NAV_SHM_MAGIC, memory_order_release);
+
+    /* Keep the page resident so publishing never faults */
+    mlock(shm, sizeof(nav_shm));
+    return shm;
+}
+
+const nav_shm *nav_shm_attach(const char *name)
+{
+    const nav_shm *shm;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(nav_shm)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    shm = mmap(NULL, sizeof(nav_shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED)
+        return NULL;
+
+    if (atomic_load_explicit((atomic_uint *)&shm->magic, memory_order_acquire) != NAV_SHM_MAGIC ||
+        shm->layout != NAV_SHM_LAYOUT || shm->size != sizeof(nav_shm)) {
+        munmap((void *)shm, sizeof(nav_shm));
+        errno = EPROTO;
+        return NULL;
+    }
+    return shm;
+}
+
+void nav_shm_detach(const nav_shm *shm)
+{
+    munmap((void *)shm, sizeof(nav_shm));
+}
+
+void nav_shm_unlink(const char *name)
+{
+    shm_unlink(name);
+}
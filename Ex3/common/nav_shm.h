@@ -0,0 +1,69 @@
+/*
+ * File: nav_shm.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: nav_state published in a POSIX shared memory segment.
+ *
+ *		The segment holds a small header and a nav_seqlock. The
+ *		publishing process creates it read-write and writes with
+ *		nav_seqlock_write() as usual. Other processes map it
+ *		read-only and copy snapshots with nav_shm_read(): no copy
+ *		through the kernel and no system call per read. A read that
+ *		keeps finding a write in progress gives up after
+ *		NAV_SHM_READ_RETRIES retries, so a publisher killed
+ *		mid-write cannot hang the reader.
+ *
+ *		The magic number is stored last, after the header and the
+ *		initial record, so an attacher never sees a half-built
+ *		segment.
+ * Date: 16th October 2026
+ */
+
+#ifndef NAV_SHM_H
+#define NAV_SHM_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "nav_seqlock.h"
+
+#define NAV_SHM_NAME   "/rtes_nav_state"
+#define NAV_SHM_MAGIC  0x4e415653u     /* "NAVS" */
+#define NAV_SHM_LAYOUT 1
+#define NAV_SHM_READ_RETRIES 65536      /* each retry yields the CPU once */
+
+typedef struct {
+    atomic_uint magic;
+    uint32_t layout;                    /* NAV_SHM_LAYOUT */
+    uint32_t size;                      /* sizeof(nav_shm) */
+    pid_t writer_pid;
+    _Alignas(64) nav_seqlock pub;
+} nav_shm;
+
+/* Create (or take over) the segment and map it read-write. Returns NULL and sets errno on failure. */
+nav_shm *nav_shm_create(const char *name, const nav_state *initial);
+
+/* Map an existing segment read-only. Returns NULL and sets errno on failure. */
+const nav_shm *nav_shm_attach(const char *name);
+
+void nav_shm_detach(const nav_shm *shm);
+
+/* Remove the name; existing mappings stay valid */
+void nav_shm_unlink(const char *name);
+
+/*
+ * Copy a consistent snapshot out of a (possibly read-only) segment. Returns
+ * the retry count, or -1 if the segment stayed mid-write for too long.
+ */
+static inline int nav_shm_read(const nav_shm *shm, nav_state *dst)
+{
+    /* A seqlock reader only loads, so a read-only mapping is enough */
+    return nav_seqlock_try_read((nav_seqlock *)&shm->pub, dst, NAV_SHM_READ_RETRIES);
+}
+
+static inline unsigned nav_shm_version(const nav_shm *shm)
+{
+    return nav_seqlock_version((nav_seqlock *)&shm->pub);
+}
+
+#endif /* NAV_SHM_H */
@@ -0,0 +1,23 @@
+/*
+ * File: nav_state.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Navigation state computation shared by Q2 and Q5.
+ * Date: 16th October 2026
+ */
+
+#include <math.h>
+
+#include "nav_state.h"
+
+void nav_state_compute(nav_state *state, const struct timespec *ts)
+{
+    double t = nav_state_seconds(ts);
+
+    state->timestamp = *ts;
+    state->Latitude = 0.01 * t;
+    state->Longitude = 0.2 * t;
+    state->Altitude = 0.25 * t;
+    state->Roll = sin(2 * PI * t);
+    state->Pitch = cos(2 * PI * t * t);
+    state->Yaw = cos(2 * PI * t);
+}
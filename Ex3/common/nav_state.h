@@ -0,0 +1,35 @@
+/*
+ * File: nav_state.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Navigation state record shared by the Q2 and Q5 programs
+ *		and the function that derives it from a timestamp.
+ * Date: 16th October 2026
+ */
+
+#ifndef NAV_STATE_H
+#define NAV_STATE_H
+
+#include <time.h>
+
+#define PI 3.14
+
+typedef struct {
+    double Latitude;
+    double Longitude;
+    double Altitude;
+    double Roll;
+    double Pitch;
+    double Yaw;
+    struct timespec timestamp;
+} nav_state;
+
+/* Timestamp in seconds including the nanosecond part */
+static inline double nav_state_seconds(const struct timespec *ts)
+{
+    return (double)ts->tv_sec + (double)ts->tv_nsec * 1e-9;
+}
+
+/* Fill every field of 'state' from 'ts' (timestamp is copied as well) */
+void nav_state_compute(nav_state *state, const struct timespec *ts);
+
+#endif /* NAV_STATE_H */
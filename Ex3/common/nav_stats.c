@@ -0,0 +1,88 @@
+/*
+ * File: nav_stats.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: nav_state pipeline latency histograms, see nav_stats.h.
+ * Date: 16th October 2026
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nav_stats.h"
+
+static pthread_t signal_thread;
+static bool signal_started;         /* signal_thread is valid */
+static sigset_t signal_set;
+static int signal_no;
+static atomic_bool signal_stop;
+static void (*signal_dump)(void);
+
+void nav_stats_init(nav_stats *st)
+{
+    hist_init(&st->age);
+    hist_init(&st->lock_wait);
+    hist_init(&st->signal_wait);
+    hist_init(&st->lock_hold);
+}
+
+void nav_stats_print(FILE *out, const char *name, const nav_stats *st)
+{
+    char label[64];
+    const struct { const char *what; const hist_t *h; } rows[] = {
+        { "age", &st->age },
+        { "lock wait", &st->lock_wait },
+        { "signal wait", &st->signal_wait },
+        { "lock hold", &st->lock_hold },
+    };
+
+    for (unsigned i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+        if (hist_count(rows[i].h) == 0)
+            continue;
+        snprintf(label, sizeof(label), "%s %s", name, rows[i].what);
+        hist_print(out, label, rows[i].h);
+    }
+}
+
+static void *signal_waiter(void *arg)
+{
+    int sig;
+
+    (void)arg;
+    while (!atomic_load(&signal_stop)) {
+        if (sigwait(&signal_set, &sig) == 0 && !atomic_load(&signal_stop))
+            signal_dump();
+    }
+    return NULL;
+}
+
+int stats_signal_start(int signo, void (*dump)(void))
+{
+    int rc;
+
+    sigemptyset(&signal_set);
+    sigaddset(&signal_set, signo);
+    rc = pthread_sigmask(SIG_BLOCK, &signal_set, NULL);
+    if (rc != 0)
+        return rc;
+
+    signal_no = signo;
+    signal_dump = dump;
+    atomic_store(&signal_stop, false);
+    rc = pthread_create(&signal_thread, NULL, signal_waiter, NULL);
+    signal_started = rc == 0;
+    return rc;
+}
+
+void stats_signal_stop(void)
+{
+    if (!signal_started)
+        return;
+    /* Not pthread_cancel(): a dump in progress may hold the stdout lock */
+    atomic_store(&signal_stop, true);
+    pthread_kill(signal_thread, signal_no);
+    pthread_join(signal_thread, NULL);
+    signal_started = false;
+}
@@ -0,0 +1,55 @@
+/*
+ * File: nav_stats.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Latency instrumentation for the nav_state pipeline.
+ *
+ *		Every thread owns one nav_stats and is the only writer of
+ *		its histograms, so recording is a few relaxed atomic stores
+ *		and never takes a lock. Any thread may print them while they
+ *		are being recorded. All values are in nanoseconds.
+ *
+ *		stats_signal_start() blocks the signal in the calling thread
+ *		(call it before creating the other threads so they inherit
+ *		the mask) and starts a thread that sigwait()s for it and runs
+ *		the dump callback, e.g. "kill -USR1 <pid>".
+ *		stats_signal_stop() sends it the same signal with a stop flag
+ *		set, so it returns between dumps and never while one holds
+ *		the stdio lock.
+ * Date: 16th October 2026
+ */
+
+#ifndef NAV_STATS_H
+#define NAV_STATS_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "hist.h"
+#include "nav_state.h"
+#include "rt_time.h"
+
+typedef struct {
+    hist_t age;             /* consume time minus sample timestamp */
+    hist_t lock_wait;       /* pthread_mutex_lock() call to acquisition */
+    hist_t signal_wait;     /* time blocked in pthread_cond_wait() */
+    hist_t lock_hold;       /* acquisition to unlock */
+} nav_stats;
+
+void nav_stats_init(nav_stats *st);
+
+/* Print every histogram of 'st' that has samples */
+void nav_stats_print(FILE *out, const char *name, const nav_stats *st);
+
+/* Record how old 'state' is now, i.e. its publish-to-consume latency */
+static inline void nav_stats_age(nav_stats *st, const nav_state *state)
+{
+    hist_record(&st->age, now_ns(CLOCK_REALTIME) - ts_to_ns(&state->timestamp));
+}
+
+/* Start the signal thread. Returns 0 or an errno value. */
+int stats_signal_start(int signo, void (*dump)(void));
+
+/* Stop the signal thread and wait for it to return; no-op if it never started */
+void stats_signal_stop(void);
+
+#endif /* NAV_STATS_H */
@@ -0,0 +1,63 @@
+/*
+ * File: periodic.c
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Drift-free periodic task support, see periodic.h.
+ * Date: 16th October 2026
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include "periodic.h"
+#include "rt_time.h"
+
+void periodic_init(periodic_task *pt, uint64_t period_ns)
+{
+    pt->period_ns = period_ns;
+    pt->next_release = now_ns(CLOCK_MONOTONIC) + period_ns;
+    pt->activations = 0;
+    pt->overruns = 0;
+    pt->skipped = 0;
+    hist_init(&pt->jitter);
+    hist_init(&pt->lateness);
+}
+
+uint64_t periodic_wait(periodic_task *pt)
+{
+    uint64_t now, missed = 0;
+    struct timespec release;
+
+    if (pt->period_ns == 0) {
+        pt->activations++;
+        return 0;
+    }
+
+    now = now_ns(CLOCK_MONOTONIC);
+    if (now > pt->next_release) {
+        /* Still busy when this release arrived; skip releases that passed entirely */
+        hist_record(&pt->lateness, now - pt->next_release);
+        missed = (now - pt->next_release) / pt->period_ns;
+        pt->next_release += missed * pt->period_ns;
+        pt->overruns++;
+        pt->skipped += missed;
+    }
+
+    release = ns_to_ts(pt->next_release);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &release, NULL) == EINTR)
+        ;
+
+    now = now_ns(CLOCK_MONOTONIC);
+    hist_record(&pt->jitter, now > pt->next_release ? now - pt->next_release : 0);
+    pt->activations++;
+    pt->next_release += pt->period_ns;
+    return missed;
+}
+
+void periodic_report(FILE *out, const char *name, const periodic_task *pt)
+{
+    fprintf(out, "%s: period %.3f ms, %lu activations, %lu overruns, %lu releases skipped\n",
+            name, pt->period_ns / 1e6, (unsigned long)pt->activations,
+            (unsigned long)pt->overruns, (unsigned long)pt->skipped);
+    hist_print(out, "  release jitter", &pt->jitter);
+    hist_print(out, "  overrun lateness", &pt->lateness);
+}
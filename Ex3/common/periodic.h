@@ -0,0 +1,44 @@
+/*
+ * File: periodic.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Drift-free periodic task support. Releases are computed as
+ *		start + k * period on CLOCK_MONOTONIC and the task sleeps with
+ *		clock_nanosleep(TIMER_ABSTIME), so the time spent working in a
+ *		period never shifts later releases.
+ *
+ *		Every activation records its release jitter (how late the task
+ *		woke up after its release time). A task that is still working
+ *		when its next release arrives has overrun; releases that have
+ *		passed entirely are skipped so the task keeps its original
+ *		phase. How late the task was for the release it missed is
+ *		recorded as its overrun lateness.
+ * Date: 16th October 2026
+ */
+
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "hist.h"
+
+typedef struct {
+    uint64_t period_ns;
+    uint64_t next_release;      /* absolute CLOCK_MONOTONIC time in ns */
+    uint64_t activations;
+    uint64_t overruns;          /* waits that started after the release time */
+    uint64_t skipped;           /* releases dropped to recover from overruns */
+    hist_t jitter;              /* wake-up time minus release time */
+    hist_t lateness;            /* per overrun: wait start time minus the missed release */
+} periodic_task;
+
+/* First release is one period from now. A zero period never sleeps. */
+void periodic_init(periodic_task *pt, uint64_t period_ns);
+
+/* Block until the next release. Returns the number of releases skipped. */
+uint64_t periodic_wait(periodic_task *pt);
+
+void periodic_report(FILE *out, const char *name, const periodic_task *pt);
+
+#endif /* PERIODIC_H */
@@ -0,0 +1,39 @@
+/*
+ * File: rt_time.h
+ * Author: Suhas Reddy and Krishna Suhagiya
+ * Description: Small timespec helpers shared by the exercise programs.
+ *		All intervals are carried as 64-bit nanosecond counts.
+ * Date: 16th October 2026
+ */
+
+#ifndef RT_TIME_H
+#define RT_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define NSEC_PER_SEC  1000000000ULL
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_USEC 1000ULL
+
+static inline uint64_t ts_to_ns(const struct timespec *ts)
+{
+    return (uint64_t)ts->tv_sec * NSEC_PER_SEC + (uint64_t)ts->tv_nsec;
+}
+
+static inline struct timespec ns_to_ts(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / NSEC_PER_SEC);
+    ts.tv_nsec = (long)(ns % NSEC_PER_SEC);
+    return ts;
+}
+
+static inline uint64_t now_ns(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return ts_to_ns(&ts);
+}
+
+#endif /* RT_TIME_H */